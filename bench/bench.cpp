@@ -0,0 +1,597 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../container/MyContainer.hpp"
+
+using namespace MyContainerNamespace;
+
+namespace {
+    // Runs the callable once and returns the elapsed wall time in milliseconds
+    template<typename Fn>
+    double timeMs(Fn fn) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    // String wrapper that counts how many times it was deep-copied or moved
+    struct CountedString {
+        static size_t copies;
+        static size_t moves;
+        std::string text;
+
+        CountedString() = default;
+        explicit CountedString(std::string text) : text(std::move(text)) {}
+        CountedString(const CountedString &other) : text(other.text) { ++copies; }
+        CountedString(CountedString &&other) noexcept : text(std::move(other.text)) { ++moves; }
+
+        CountedString &operator=(const CountedString &other) {
+            text = other.text;
+            ++copies;
+            return *this;
+        }
+
+        CountedString &operator=(CountedString &&other) noexcept {
+            text = std::move(other.text);
+            ++moves;
+            return *this;
+        }
+
+        bool operator==(const CountedString &other) const { return text == other.text; }
+        bool operator!=(const CountedString &other) const { return text != other.text; }
+        bool operator<(const CountedString &other) const { return text < other.text; }
+        bool operator>(const CountedString &other) const { return text > other.text; }
+    };
+
+    size_t CountedString::copies = 0;
+    size_t CountedString::moves = 0;
+
+    // Forwards to new/delete and counts the allocations, i.e. the reallocations of a container
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    /**
+     * Runs the growth workloads for one policy: a bulk load of n ints with and without reserve(),
+     * and fill/drain churn where shrinking policies reallocate on the way down and up again.
+     */
+    template<typename Policy>
+    void benchPolicy(const char *name, size_t n) {
+        CountingResource counting;
+        size_t capacity = 0;
+        const double load = timeMs([&] {
+            MyContainer<int, 0, Policy> c(&counting);
+            for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(i));
+            capacity = c.capacity();
+        });
+        const size_t loadAllocations = counting.allocations;
+
+        counting.allocations = 0;
+        const double reserved = timeMs([&] {
+            MyContainer<int, 0, Policy> c(&counting);
+            c.reserve(n);
+            for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(i));
+        });
+        const size_t reservedAllocations = counting.allocations;
+
+        // Fill and drain repeatedly: shrinking policies give the memory back and regrow every cycle
+        counting.allocations = 0;
+        const int cycles = 200;
+        const int batch = 1000;
+        const double churn = timeMs([&] {
+            MyContainer<int, 0, Policy> c(&counting);
+            c.add(-1);
+            for (int cycle = 0; cycle < cycles; ++cycle) {
+                for (int i = 0; i < batch; ++i) c.add(i);
+                for (int i = batch - 1; i >= 0; --i) c.remove(i);
+            }
+        });
+
+        std::cout << "  " << name << ": load " << load << " ms (" << loadAllocations << " allocs, capacity "
+                  << capacity << "), reserved load " << reserved << " ms (" << reservedAllocations
+                  << " allocs), churn " << churn << " ms (" << counting.allocations << " allocs)\n";
+    }
+
+    void benchGrowth(size_t n) {
+        std::cout << "== growth policies: " << n << " ints ==\n";
+        benchPolicy<OneAndHalfGrowth>("1.5x        ", n);
+        benchPolicy<DoublingGrowth>("2x          ", n);
+        benchPolicy<NeverShrinkGrowth>("never shrink", n);
+    }
+
+    /**
+     * Fills a container with long strings through add(const T&), add(T&&) and emplace()
+     * and reports the time and the number of deep copies each path made.
+     */
+    void benchMoves(size_t n) {
+        std::cout << "== moves: " << n << " strings of 64 chars ==\n";
+        const std::string text(64, 'x');
+
+        auto report = [](const char *name, double ms) {
+            std::cout << "  " << name << ": " << ms << " ms, copies=" << CountedString::copies
+                      << ", moves=" << CountedString::moves << '\n';
+            CountedString::copies = CountedString::moves = 0;
+        };
+
+        double ms = timeMs([&] {
+            MyContainer<CountedString> c;
+            const CountedString value(text);
+            for (size_t i = 0; i < n; ++i) c.add(value);
+        });
+        report("add(const T&)", ms);
+
+        ms = timeMs([&] {
+            MyContainer<CountedString> c;
+            for (size_t i = 0; i < n; ++i) c.add(CountedString(text));
+        });
+        report("add(T&&)     ", ms);
+
+        ms = timeMs([&] {
+            MyContainer<CountedString> c;
+            for (size_t i = 0; i < n; ++i) c.emplace(text);
+        });
+        report("emplace      ", ms);
+    }
+
+    // Loads n ints one add() at a time and in bulk
+    void benchBulk(size_t n) {
+        std::cout << "== bulk load: " << n << " ints ==\n";
+        std::vector<int> values(n);
+        for (size_t i = 0; i < n; ++i) values[i] = static_cast<int>(i);
+
+        double ms = timeMs([&] {
+            MyContainer<int> c;
+            for (const int v : values) c.add(v);
+        });
+        std::cout << "  add() loop : " << ms << " ms\n";
+
+        ms = timeMs([&] {
+            MyContainer<int> c;
+            c.addRange(values.begin(), values.end());
+        });
+        std::cout << "  addRange() : " << ms << " ms\n";
+
+        ms = timeMs([&] {
+            MyContainer<int> c;
+            c.append(values.data(), values.size());
+        });
+        std::cout << "  append()   : " << ms << " ms\n";
+    }
+
+    // Grows a container of n ints element by element with copy-on-grow and with in-place realloc
+    void benchRealloc(size_t n) {
+        std::cout << "== growth of " << n << " ints: copy vs realloc ==\n";
+        auto grow = [n](std::pmr::memory_resource *resource) {
+            return timeMs([&] {
+                MyContainer<int> c(resource);
+                for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(i));
+            });
+        };
+        std::cout << "  new/delete + memcpy : " << grow(std::pmr::new_delete_resource()) << " ms\n";
+        std::cout << "  ReallocResource     : " << grow(reallocResource()) << " ms\n";
+    }
+
+    // Small batches of adds into a large container, each followed by an ascending read:
+    // the incrementally merged index against a full re-sort (forced by writing through at())
+    void benchIndex(size_t n) {
+        constexpr int batches = 100;
+        constexpr int batch = 16;
+        std::cout << "== " << batches << " batches of " << batch << " adds into " << n << " ints ==\n";
+        auto run = [n](bool resort) {
+            MyContainer<int> c;
+            for (size_t i = 0; i < n; ++i) c.add(static_cast<int>((i * 2654435761u) % n));
+            c.beginAscendingOrder();
+            return timeMs([&] {
+                for (int b = 0; b < batches; ++b) {
+                    for (int i = 0; i < batch; ++i) c.add(b * batch + i);
+                    if (resort) c.at(0) = c.at(0);
+                    volatile int smallest = *c.beginAscendingOrder();
+                    (void) smallest;
+                }
+            });
+        };
+        std::cout << "  merged index : " << run(false) << " ms\n";
+        std::cout << "  full re-sort : " << run(true) << " ms\n";
+    }
+
+    // Many short reverse and middle-out scans over a large container
+    void benchScans(size_t n) {
+        constexpr int scans = 10000;
+        std::cout << "== " << scans << " scans of 8 elements over " << n << " ints ==\n";
+        MyContainer<int> c;
+        for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(i));
+        long long sum = 0;
+        const double reverse = timeMs([&] {
+            for (int s = 0; s < scans; ++s) {
+                auto it = c.beginReverseOrder();
+                for (int k = 0; k < 8; ++k, ++it) sum += *it;
+            }
+        });
+        const double middle = timeMs([&] {
+            for (int s = 0; s < scans; ++s) {
+                auto it = c.beginMiddleOutOrder();
+                for (int k = 0; k < 8; ++k, ++it) sum += *it;
+            }
+        });
+        std::cout << "  reverse    : " << reverse << " ms\n";
+        std::cout << "  middle-out : " << middle << " ms (" << sum << ")\n";
+    }
+
+    // A plain begin()/end() loop and a range-for over n ints against a raw pointer loop: what every
+    // begin()/end() call and element iterator costs on top of the loop itself
+    void benchLoop(size_t n) {
+        std::cout << "== plain loops over " << n << " ints ==\n";
+        MyContainer<int> c;
+        std::vector<int> values(n);
+        for (size_t i = 0; i < n; ++i) values[i] = static_cast<int>(i % 1000);
+        c.append(values.data(), n);
+        long long sum = 0;
+        const int *first = &std::as_const(c).at(0);
+        const double raw = timeMs([&] {
+            for (const int *p = first; p != first + n; ++p) sum += *p;
+        });
+        const double loop = timeMs([&] {
+            for (auto it = c.begin(); it != c.end(); ++it) sum += *it;
+        });
+        const double range = timeMs([&] {
+            for (int value : c) sum += value;
+        });
+        std::cout << "  raw pointers  : " << raw << " ms\n";
+        std::cout << "  begin()/end() : " << loop << " ms\n";
+        std::cout << "  range-for     : " << range << " ms (" << sum << ")\n";
+    }
+
+    // The k smallest elements through the lazy ascending order against the fully sorted one
+    void benchLazy(size_t n) {
+        std::cout << "== k smallest of " << n << " ints ==\n";
+        for (size_t k : {size_t{10}, size_t{1000}, n}) {
+            auto run = [n, k](bool lazy) {
+                MyContainer<int> c;
+                for (size_t i = 0; i < n; ++i) c.add(static_cast<int>((i * 2654435761u) % n));
+                long long sum = 0;
+                const double ms = timeMs([&] {
+                    auto it = lazy ? c.beginLazyAscendingOrder() : c.beginAscendingOrder();
+                    for (size_t i = 0; i < k; ++i, ++it) sum += *it;
+                });
+                volatile long long sink = sum;
+                (void) sink;
+                return ms;
+            };
+            std::cout << "  k = " << k << "\n";
+            std::cout << "    lazy   : " << run(true) << " ms\n";
+            std::cout << "    sorted : " << run(false) << " ms\n";
+        }
+    }
+
+    // A leaderboard of the k largest through topK against sorting everything with sortedWith
+    void benchTopK(size_t n) {
+        constexpr size_t k = 100;
+        std::cout << "== top " << k << " of " << n << " ints ==\n";
+        MyContainer<int> c;
+        for (size_t i = 0; i < n; ++i) c.add(static_cast<int>((i * 2654435761u) % n));
+        long long sum = 0;
+        const double heap = timeMs([&] {
+            for (int value : c.topK(k)) sum += value;
+        });
+        const double sorted = timeMs([&] {
+            auto view = c.sortedWith(std::greater<int>());
+            for (size_t i = 0; i < k; ++i) sum += view[i];
+        });
+        std::cout << "  topK       : " << heap << " ms\n";
+        std::cout << "  sortedWith : " << sorted << " ms (" << sum << ")\n";
+    }
+
+    // Building the ascending view of n ints with 1, 2, 4... threads up to the hardware
+    void benchParallel(size_t n) {
+        std::cout << "== ascending view of " << n << " ints by thread count ==\n";
+        const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threads = 1;; threads = std::min(threads * 2, hardware)) {
+            ParallelSort::setThreads(threads);
+            MyContainer<int> c;
+            for (size_t i = 0; i < n; ++i) c.add(static_cast<int>((i * 2654435761u) % n));
+            const double ms = timeMs([&] {
+                volatile int smallest = *c.beginAscendingOrder();
+                (void) smallest;
+            });
+            std::cout << "  " << threads << " threads : " << ms << " ms\n";
+            if (threads == hardware) break;
+        }
+        ParallelSort::setThreads(0);
+    }
+
+    // The ascending view of arithmetic elements, radix sorted, against the same order by a comparison sort
+    template<typename T>
+    void benchRadixType(const char *name, size_t n) {
+        std::mt19937_64 random(42);
+        MyContainer<T> c;
+        for (size_t i = 0; i < n; ++i) c.add(static_cast<T>(random() % n) - static_cast<T>(n / 2));
+        const double radix = timeMs([&] {
+            volatile T smallest = *c.beginAscendingOrder();
+            (void) smallest;
+        });
+        const double comparison = timeMs([&] {
+            volatile T smallest = *c.beginSortedWith([](const T &a, const T &b) { return a < b; });
+            (void) smallest;
+        });
+        std::cout << "  " << name << " radix : " << radix << " ms, comparison : " << comparison << " ms\n";
+    }
+
+    void benchRadix(size_t n) {
+        std::cout << "== ascending view of " << n << " elements ==\n";
+        benchRadixType<int>("int   ", n);
+        benchRadixType<size_t>("size_t", n);
+        benchRadixType<double>("double", n);
+        benchRadixType<char>("char  ", n);
+    }
+
+    // Many small ascending views, sorted by the vector kernels, against a comparison sort
+    template<typename T>
+    void benchSimdType(const char *name, size_t size) {
+        constexpr int rounds = 20000;
+        std::mt19937_64 random(42);
+        MyContainer<T> c;
+        for (size_t i = 0; i < size; ++i) c.add(static_cast<T>(random() % 100000) + 1);
+        const double kernels = timeMs([&] {
+            for (int r = 0; r < rounds; ++r) {
+                c.at(0) = c.at(0); // the view must be built again
+                volatile T smallest = *c.beginAscendingOrder();
+                (void) smallest;
+            }
+        });
+        const double comparison = timeMs([&] {
+            for (int r = 0; r < rounds; ++r) {
+                volatile T smallest = *c.beginSortedWith([](const T &a, const T &b) { return a < b; });
+                (void) smallest;
+            }
+        });
+        std::cout << "  " << name << " kernels : " << kernels << " ms, comparison : " << comparison << " ms\n";
+    }
+
+    void benchSimd() {
+        const char *levels[] = {"scalar", "SSE2", "AVX2"};
+        std::cout << "== 20000 ascending views of small containers (" << levels[SimdSort::best()] << ") ==\n";
+        for (size_t size : {size_t{32}, size_t{200}}) {
+            std::cout << "  " << size << " elements\n";
+            benchSimdType<int>("  int   ", size);
+            benchSimdType<float>("  float ", size);
+            benchSimdType<double>("  double", size);
+        }
+    }
+
+    // A record whose name getter returns a copy, like People::getName
+    struct Person {
+        std::string name;
+        int age;
+
+        std::string getName() const { return name; }
+
+        bool operator<(const Person &other) const { return age < other.age; }
+    };
+
+    // Sorting records by name: a comparator calling the getter against one key extraction per element
+    void benchSortedBy(size_t n) {
+        std::cout << "== " << n << " records sorted by name ==\n";
+        MyContainer<Person> c;
+        for (size_t i = 0; i < n; ++i) {
+            c.add(Person{"person number " + std::to_string((i * 2654435761u) % n), static_cast<int>(i % 100)});
+        }
+        const double with = timeMs([&] {
+            c.beginSortedWith([](const Person &a, const Person &b) { return a.getName() < b.getName(); });
+        });
+        const double by = timeMs([&] {
+            c.beginSortedBy([](const Person &p) { return p.getName(); });
+        });
+        std::cout << "  sortedWith : " << with << " ms\n";
+        std::cout << "  sortedBy   : " << by << " ms\n";
+    }
+
+    // Ascending views of nearly sorted data: appended in order, written through at() at a few
+    // places (no flag, the runs are found), and shuffled for reference
+    void benchRuns(size_t n) {
+        std::cout << "== ascending view of " << n << " nearly sorted Persons ==\n";
+        auto run = [n](int disorder) {
+            MyContainer<Person> c;
+            for (size_t i = 0; i < n; ++i) c.add(Person{"", static_cast<int>(i)});
+            std::mt19937_64 random(42);
+            if (disorder < 0) {
+                for (size_t i = 0; i < n; ++i) c.at(i).age = static_cast<int>(random() % n);
+            }
+            for (int d = 0; d < disorder; ++d) c.at(random() % n).age = static_cast<int>(random() % n);
+            return timeMs([&] { c.beginAscendingOrder(); });
+        };
+        std::cout << "  in order        : " << run(0) << " ms\n";
+        std::cout << "  10 out of place : " << run(10) << " ms\n";
+        std::cout << "  shuffled        : " << run(-1) << " ms\n";
+    }
+
+    // Reading the whole ascending order in memory against within budgets of a fraction of the data
+    void benchExternal(size_t n) {
+        std::cout << "== ascending order of " << n << " ints read once ==\n";
+        std::mt19937_64 random(42);
+        MyContainer<int> c;
+        for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(random() % n));
+        long long sum = 0;
+        const double memory = timeMs([&] {
+            for (int value : c.ascending()) sum += value;
+        });
+        std::cout << "  in memory       : " << memory << " ms\n";
+        for (size_t fraction : {size_t{4}, size_t{64}}) {
+            const size_t budget = n * sizeof(int) / fraction;
+            size_t runs = 0;
+            const double external = timeMs([&] {
+                auto view = c.externalAscending(budget);
+                for (int value : view) sum += value;
+                runs = view.runCount();
+            });
+            std::cout << "  budget 1/" << fraction << (fraction < 10 ? "      : " : "     : ") << external << " ms, " << runs << " runs (" << sum << ")\n";
+        }
+    }
+
+    // contains() and remove() on n ints with and without the hash index, most probes miss
+    void benchHashIndex(size_t n) {
+        std::cout << "== membership in " << n << " ints ==\n";
+        std::mt19937_64 random(42);
+        std::vector<int> values(n);
+        for (int &value : values) value = static_cast<int>(random() % (2 * n));
+        std::vector<int> probes(2000);
+        for (int &probe : probes) probe = static_cast<int>(random() % (4 * n));
+        for (bool indexed : {false, true}) {
+            MyContainer<int> c;
+            if (indexed) c.setHashIndex(true);
+            c.append(values.data(), values.size());
+            size_t hits = 0;
+            c.contains(0); // an index is built by the first lookup
+            const double contains = timeMs([&] {
+                for (int probe : probes) hits += c.contains(probe);
+            });
+            size_t removed = 0;
+            const double remove = timeMs([&] {
+                for (size_t i = 0; i < 100; ++i) {
+                    try {
+                        c.remove(probes[i]);
+                        ++removed;
+                    } catch (const ElementNotFound &) {
+                    }
+                }
+            });
+            std::cout << (indexed ? "  hash index" : "  scan      ") << " : " << probes.size() << " contains " << contains
+                      << " ms (" << hits << " hits), 100 removes " << remove << " ms (" << removed << " found)\n";
+        }
+    }
+
+    // contains(), find() and count() on n ints: the loops they used to be against the kernels at each level
+    void benchSearch(size_t n) {
+        std::cout << "== search of " << n << " ints ==\n";
+        std::mt19937_64 random(42);
+        std::vector<int> values(n);
+        for (int &value : values) value = static_cast<int>(random() % n);
+        const int missing = -1;
+        const int last = values[n - 1];
+        MyContainer<int> c;
+        c.append(values.data(), values.size());
+        size_t sink = 0;
+        const double loop_contains = timeMs([&] {
+            bool found = false;
+            for (size_t i = 0; i < n && !found; ++i) found = values[i] == missing;
+            sink += found;
+        });
+        const double loop_find = timeMs([&] {
+            const int *first = &std::as_const(c).at(0); // the container's own storage, no iterator overhead
+            sink += static_cast<size_t>(std::find(first, first + n, missing) - first);
+        });
+        const double loop_count = timeMs([&] {
+            size_t found = 0;
+            for (size_t i = 0; i < n; ++i) found += values[i] == last;
+            sink += found;
+        });
+        std::cout << "  old loops : contains " << loop_contains << " ms, find " << loop_find << " ms, count " << loop_count << " ms\n";
+        for (SimdSort::Level level : {SimdSort::Scalar, SimdSort::Sse2, SimdSort::Avx2}) {
+            if (!SimdSort::supports(level)) continue;
+            const int *first = values.data();
+            const double find = timeMs([&] { sink += SimdSearch::find(first, first + n, missing, level); });
+            const double count = timeMs([&] { sink += SimdSearch::count(first, first + n, last, level); });
+            const char *name = level == SimdSort::Scalar ? "scalar" : level == SimdSort::Sse2 ? "SSE2  " : "AVX2  ";
+            std::cout << "  " << name << "    : find " << find << " ms, count " << count << " ms\n";
+        }
+        const double contains = timeMs([&] { sink += c.contains(missing); });
+        const double find = timeMs([&] { sink += c.find(missing) == c.end(); });
+        const double count = timeMs([&] { sink += c.count(last); });
+        std::cout << "  container : contains " << contains << " ms, find " << find << " ms, count " << count << " ms (" << sink << ")\n";
+    }
+
+    // 1000 "how many elements in [lo, hi)" queries on an unchanged container: traversal against binary search
+    void benchRange(size_t n) {
+        std::cout << "== 1000 range counts over " << n << " ints ==\n";
+        std::mt19937_64 random(42);
+        MyContainer<int> c;
+        for (size_t i = 0; i < n; ++i) c.add(static_cast<int>(random() % n));
+        std::vector<int> bounds(1000);
+        for (int &bound : bounds) bound = static_cast<int>(random() % n);
+        size_t sink = 0;
+        c.countInRange(0, 1); // both sides read the same cached view
+        const double traversal = timeMs([&] {
+            for (size_t q = 0; q < 20; ++q) {
+                const int lo = bounds[q];
+                const int hi = lo + static_cast<int>(n / 100);
+                for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder() && *it < hi; ++it) {
+                    sink += *it >= lo;
+                }
+            }
+        }) * 50;
+        const double search = timeMs([&] {
+            for (int lo : bounds) sink += c.countInRange(lo, lo + static_cast<int>(n / 100));
+        });
+        std::cout << "  traversal      : " << traversal << " ms (20 queries x 50)\n";
+        std::cout << "  countInRange   : " << search << " ms (" << sink << ")\n";
+    }
+
+    // 10^6 random lower bounds in sorted arrays of 10^3 up to largest ints: std::lower_bound against the Eytzinger layout
+    void benchEytzinger(size_t largest) {
+        std::cout << "== 1000000 lower bounds, sorted array against Eytzinger layout ==\n";
+        std::mt19937_64 random(42);
+        std::vector<int> probes(1000000);
+        for (size_t n = 1000; n <= largest; n *= 10) {
+            std::vector<int> sorted(n);
+            for (size_t i = 0; i < n; ++i) sorted[i] = static_cast<int>(2 * i);
+            for (int &probe : probes) probe = static_cast<int>(random() % (2 * n));
+            EytzingerLayout<int> layout(std::pmr::get_default_resource());
+            const double build = timeMs([&] { layout.build(sorted.data(), n); });
+            size_t sink = 0;
+            const double flat = timeMs([&] {
+                for (int probe : probes) sink += static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+            });
+            const double eytzinger = timeMs([&] {
+                for (int probe : probes) sink -= layout.lowerBound(probe);
+            });
+            std::cout << "  n = " << n << " : lower_bound " << flat << " ms, Eytzinger " << eytzinger << " ms (build "
+                      << build << " ms, " << sink << ")\n";
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const std::string which = argc > 1 ? argv[1] : "all";
+    const size_t n = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    if (which == "all" || which == "moves") benchMoves(n);
+    if (which == "all" || which == "growth") benchGrowth(n);
+    if (which == "all" || which == "bulk") benchBulk(n);
+    if (which == "all" || which == "realloc") benchRealloc(n);
+    if (which == "all" || which == "index") benchIndex(n);
+    if (which == "all" || which == "scans") benchScans(n);
+    if (which == "all" || which == "loop") benchLoop(10 * n);
+    if (which == "all" || which == "lazy") benchLazy(n);
+    if (which == "all" || which == "topk") benchTopK(n);
+    if (which == "all" || which == "parallel") benchParallel(n);
+    if (which == "all" || which == "radix") benchRadix(n);
+    if (which == "all" || which == "simd") benchSimd();
+    if (which == "all" || which == "sortedby") benchSortedBy(n / 4);
+    if (which == "all" || which == "runs") benchRuns(n);
+    if (which == "all" || which == "external") benchExternal(n);
+    if (which == "all" || which == "hash") benchHashIndex(n);
+    if (which == "all" || which == "search") benchSearch(10 * n);
+    if (which == "all" || which == "range") benchRange(n);
+    if (which == "all" || which == "eytzinger") benchEytzinger(100 * n);
+    return 0;
+}
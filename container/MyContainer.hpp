@@ -1,60 +1,335 @@
 #pragma once
 #include <iostream>
 #include "MyContainerExceptions.hpp"
+#include "MyContainerEytzinger.hpp"
+#include "MyContainerExternalSort.hpp"
+#include "MyContainerGrowthPolicy.hpp"
+#include "MyContainerHashIndex.hpp"
+#include "MyContainerMemory.hpp"
+#include "MyContainerSimdSearch.hpp"
+#include "MyContainerSimdSort.hpp"
+#include "MyContainerSort.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 using namespace std;
 
 namespace MyContainerNamespace {
+    /**
+     * Uninitialized space for Capacity elements inside the owning object.
+     * The zero-capacity specialization has no storage and data() returns nullptr.
+     */
+    template<typename T, size_t Capacity>
+    struct InlineStorage {
+        alignas(T) unsigned char bytes[sizeof(T) * Capacity];
+
+        T *data() { return reinterpret_cast<T *>(bytes); }
+
+        const T *data() const { return reinterpret_cast<const T *>(bytes); }
+    };
+
     template<typename T>
+    struct InlineStorage<T, 0> {
+        T *data() { return nullptr; }
+
+        const T *data() const { return nullptr; }
+    };
+
+    /**
+     * @tparam T the element type
+     * @tparam InlineCapacity number of elements kept inside the object before anything is heap-allocated,
+     * ordered views of up to that many elements are built in inline scratch space as well
+     * @tparam GrowthPolicy when and how much the capacity grows and shrinks, see MyContainerGrowthPolicy.hpp
+     */
+    template<typename T, size_t InlineCapacity = 0, typename GrowthPolicy = DoublingGrowth>
     class MyContainer {
     private:
+        std::pmr::memory_resource *resource; // where the elements and every ordered view buffer are allocated
+        InlineStorage<T, InlineCapacity> inlineElements; // home of the elements while they fit
         T *elements; // pointer to the array of elements
-        size_t capacity; // current capacity of the container
+        size_t _capacity; // current capacity of the container
         size_t _size; // current size of the container
 
-        size_t activeIterators = 0;
+        std::atomic<size_t> activeIterators{0}; // live iterators of ordered views and views, they may be on other threads
+        size_t elementIterators = 0; // live begin(), find() and other iterators straight over the elements, own thread only
+        mutable std::mutex viewMutex; // taken to build, update or retire views, so they can be started from several threads
         friend class Iterator;
 
-        T *orderedCopy = nullptr; // Temporary buffer used to hold a dynamically generated view of the container
+        // Views of small trivially copyable elements hold copies of them, views of anything else hold a
+        // permutation of indices into elements, 4 bytes per element instead of a deep copy of every T
+        static constexpr bool permutedViews = !std::is_trivially_copyable_v<T> || sizeof(T) > sizeof(uint64_t);
+
+        // A materialized ordered view of the elements, reused until the container changes
+        struct OrderedView {
+            void *buffer = nullptr; // the slots: copies of T, or uint32_t/uint64_t indices when permutedViews
+            size_t size = 0; // number of constructed slots in buffer
+            size_t capacity = 0; // number of slots buffer was allocated for
+            size_t generation = 0; // the container generation the view was built from
+            size_t structure = 0; // the container structure it was built from, see structure
+            bool wide = false; // 64-bit indices, only needed past 2^32 elements
+            bool built = false;
+        };
+
+        // Orders that need a materialized view, reverse and middle out are computed by the iterator
+        // and side cross walks the ascending view from both ends
+        enum OrderKind { Ascending, Descending, OrderKindCount };
+
+        std::atomic<size_t> generation{0}; // bumped by every (possible) change of the elements, stale views are rebuilt
+        size_t structure = 0; // bumped by adds, removes and moves only: views of one structure have the same size
+        OrderedView views[OrderKindCount]; // one cached view per order kind
+        OrderedView customView; // the beginSortedWith / beginSortedBy view, never reused
+        OrderedView rankedView; // the topK() / bottomK() view, never reused either
+        std::vector<OrderedView> retiredViews; // replaced while iterators were alive, freed once they are gone
+
+        // Incremental quicksort behind the lazy ascending order: only the part that was read is sorted.
+        // Indices are compared by (element, index), so the order is stable and every key is distinct.
+        struct LazySort {
+            void *indices = nullptr; // uint32_t, or uint64_t when wide, positions [0, settled) are final
+            size_t size = 0;
+            bool wide = false;
+            size_t generation = 0;
+            size_t structure = 0;
+            std::vector<size_t> pivots; // pivot positions not reached yet, descending, the bottom one is size
+            std::atomic<size_t> settled{0}; // read without the lock by iterators
+        };
+
+        std::unique_ptr<LazySort> lazySort;
+        std::vector<std::unique_ptr<LazySort>> retiredLazySorts; // like retiredViews
+
+        // views[Ascending] is a stable sorted view of elements[0, views[Ascending].size) that add() and
+        // remove() keep valid, new elements are merged into it instead of sorting everything again
+        bool ascendingIndexed = false;
+
+        // The elements are known to be non-decreasing / strictly decreasing, checked by add() against the
+        // last element so a sorted container needs no sort at all. Cleared when elements may be written
+        bool inAscendingRun = true;
+        bool inDescendingRun = true;
+
+        // The generation ascendingIndexed and the run flags were last checked against. Writes in place only
+        // bump generation, settleWrites() drops what they invalidated before the next add, remove or build
+        size_t trackedGeneration = 0;
+
+        // Counts of the distinct elements, for contains() and remove() without a scan. Kept up to date by
+        // adds, removes and set() while fresh. hashIndexWritten is set by everything that hands out a
+        // writable reference (at(), begin()...), the next lookup then rebuilds the index; it is only
+        // ever stored relaxed, a plain store, and atomic because const lookups may clear it concurrently
+        mutable HashIndex<T> hashIndex;
+        bool hashIndexEnabled = false;
+        mutable std::atomic<bool> hashIndexFresh{false};
+        mutable std::atomic<bool> hashIndexWritten{false};
+
+        // A copy of the ascending view in Eytzinger order for cache-friendly searches, see setEytzingerLayout().
+        // Built from an up to date view of copies, layoutGeneration is the generation it mirrors
+        static constexpr size_t eytzingerMinimum = 4096; // below this a flat binary search stays in cache
+        mutable EytzingerLayout<T> eytzinger;
+        bool eytzingerEnabled = false;
+        mutable std::atomic<size_t> layoutGeneration{std::numeric_limits<size_t>::max()};
+
+        InlineStorage<T, InlineCapacity> inlineView; // home of one small ordered view
+
+        // Raw storage, the scratch when given and count fits in it, otherwise from the memory resource
+        T *allocate(size_t count, T *scratch) const;
+
+        void deallocate(T *buffer, size_t count) const;
+
+        // Raw storage for count view slots, the inline view storage when it is given and they fit in it
+        template<typename Slot>
+        Slot *allocateSlots(size_t count, void *scratch) const;
+
+        template<typename Slot>
+        void deallocateSlots(Slot *slots, size_t count) const;
+
+        // Call fn with buffer cast to the slot type of the views (T, uint32_t or uint64_t)
+        template<typename Fn>
+        void withSlots(bool wide, void *buffer, Fn fn) const;
+
+        bool wideIndices() const; // Views of the current elements need 64-bit indices
+
+        template<typename Slot>
+        const T &slotValue(const Slot &slot) const; // The element a slot stands for
+
+        template<typename Slot>
+        void constructSlot(Slot *dest, size_t index) const; // Construct the slot standing for elements[index]
+
+        static void relocate(T *source, size_t count, T *dest); // Move (or copy) into raw storage
+
+        void releaseElements(); // Destroy the live elements and free the buffer
+
+        void releaseView(OrderedView &view); // Destroy and free an ordered view buffer
+
+        void retireView(OrderedView &view); // Release a view now, or once no iterator can point into it
+
+        void releaseRetiredViews();
+
+        void releaseLazySort(LazySort &lazy);
+
+        LazySort &cachedLazySort(); // The lazy sort of the current elements, started if missing or stale
+
+        void settleLazy(LazySort &lazy, size_t position); // Sort until position holds its final element
+
+        template<typename Index>
+        void settleLazyWith(LazySort &lazy, size_t position);
+
+        void adoptView(OrderedView &view, void *buffer); // Make a fresh buffer of _size slots the view
+
+        void *viewScratch(); // The inline view storage if no view occupies it, otherwise nullptr
+
+        void markWritten(); // The elements may be changed in place, every view is stale
+
+        void settleWrites(); // Forget the ascending index and the run flags if elements were written in place since
+
+        void markChanged(); // Elements were added or removed, every view is stale
+
+        bool iterating() const; // Whether iterators or views are alive, elements cannot be added or removed then
+
+        void noteAppended(size_t first); // Update the run flags and the hash index for the elements added from first on
+
+        bool freshHashIndex() const; // Whether the hash index can be used, rebuilt first if it is stale
+
+        // The position of the first element equal to value at or after from, _size if there is none
+        size_t indexOf(const T &value, size_t from) const;
+
+        // The Eytzinger layout of the ascending view if it is enabled, worth it and can be had, otherwise nullptr.
+        // The view must be up to date, or the layout is only used if it already is; call with the view lock held
+        const EytzingerLayout<T> *freshLayout() const;
+
+        // Stable sort of slots with comp, picking the cheapest way for the data and the element type
+        template<typename Slot, typename Comparator, typename SlotLess>
+        void sortSlots(Slot *first, Slot *last, Comparator comp, SlotLess less) const;
+
+        template<typename Slot>
+        void mergeIntoIndex(); // Sort the elements added since the ascending index was built into it
+
+        // Drop removed elements from the index, given their positions before remove() compacted the elements
+        template<typename Slot>
+        void pruneIndex(const T &element, const std::vector<size_t> &removed);
+
+        OrderedView &cachedView(OrderKind kind); // The view of that order, rebuilt if the container changed
+
+        OrderedView &endView(OrderKind kind); // The view the end iterators of that order are made from
+
+        template<typename Slot>
+        void buildView(OrderedView &view, OrderKind kind);
 
         void resize(size_t new_capacity); // Change the capacity of the container
 
-        T *createSortedCopyAscending() const;
+        bool tryReallocate(size_t new_capacity); // Resize trivially copyable elements in place if possible
 
-        T *createSortedCopyDescending() const;
+        // Construct count new elements at the end with construct(dest), reallocating at most once
+        template<typename ConstructFn>
+        void appendWith(size_t count, ConstructFn construct);
 
-        T *createReverseCopy() const;
+        template<typename Slot, typename MakeFn>
+        Slot *createSlots(MakeFn make, void *scratch) const;
 
-        T *createSideCrossCopy() const;
+        template<typename Slot, typename MakeFn, typename LessFn>
+        Slot *createDescendingSlots(MakeFn make, LessFn less, void *scratch) const;
 
-        T *createMiddleOutCopy() const;
+        template<typename Slot, typename Comparator>
+        Slot *createSortedSlots(Comparator comp, void *scratch) const;
 
-        template<typename Comparator>
-        T *createSortedCopyWith(Comparator comp) const;
+        // Sort copies of integer or floating-point elements without comparisons when comp is < or >:
+        // vector kernels for small ranges, a radix sort for larger ones. false if that does not apply
+        template<typename Slot, typename Comparator>
+        bool arithmeticSort(Slot *first, Slot *last, Comparator comp) const;
+
+        // Slots ordered by the key of their element, each key computed once
+        template<typename Slot, typename KeyFn>
+        Slot *createKeyedSlots(KeyFn key, void *scratch) const;
+
+        // The k first slots of the stable order of comp, with a bounded heap in O(n log k)
+        template<typename Slot, typename Comparator>
+        Slot *createBestSlots(size_t k, Comparator comp) const;
 
     public:
-        // default constructor
-        MyContainer<T>();
+        // default constructor, allocates from the default memory resource
+        MyContainer();
+
+        // constructor allocating from the given memory resource, e.g. a monotonic arena
+        explicit MyContainer(std::pmr::memory_resource *resource);
+
+        // range constructor, copies [first, last) with a single allocation
+        template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+        MyContainer(InputIt first, InputIt last,
+                    std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
         // destructor
-        ~MyContainer<T>();
+        ~MyContainer();
+
+        // copy constructor, the copy uses the default memory resource like std::pmr containers
+        MyContainer(const MyContainer &other);
 
-        // copy constructor
-        MyContainer<T>(const MyContainer<T> &other);
+        // copy constructor allocating the copy from the given memory resource
+        MyContainer(const MyContainer &other, std::pmr::memory_resource *resource);
 
         // copy assignment operator
-        MyContainer<T> &operator=(const MyContainer<T> &other);
+        MyContainer &operator=(const MyContainer &other);
+
+        // move constructor, steals the other container's buffer and memory resource
+        MyContainer(MyContainer &&other) noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>);
+
+        // move assignment operator, moves element by element if the memory resources differ
+        MyContainer &operator=(MyContainer &&other);
+
+        // the memory resource this container allocates from
+        std::pmr::memory_resource *getMemoryResource() const;
 
         // add element needs to add throw when full, if there are multi of the same val, add all of them
         void add(const T &element);
 
+        // add element by moving it into the container
+        void add(T &&element);
+
+        // construct an element in place from the given arguments
+        template<typename... Args>
+        T &emplace(Args &&... args);
+
+        // add every element of [first, last), reallocating at most once for forward iterators
+        template<typename InputIt>
+        void addRange(InputIt first, InputIt last);
+
+        // add all the listed elements, reallocating at most once
+        void add(std::initializer_list<T> values);
+
+        // add count elements copied from a contiguous array, a single memcpy for trivially copyable T
+        void append(const T *values, size_t count);
+
         // remove element, if not found, throw exception
         void remove(const T &element);
 
+        // access an element, counts as a change of the container since the element can be written through
         T &at(size_t index);
 
+        // write an element, keeping the hash index up to date as well
+        void set(size_t index, const T &value);
+
+        // read-only access to an element
+        const T &at(size_t index) const;
+
+        // make room for at least new_capacity elements, so that many adds do not reallocate
+        void reserve(size_t new_capacity);
+
+        // give back the unused capacity
+        void shrinkToFit();
+
+        // return the number of elements the container can hold before it reallocates
+        size_t capacity() const;
+
         // return the size of the container
         size_t size() const;
 
@@ -64,8 +339,23 @@ namespace MyContainerNamespace {
         // check if an element is inside the container
         bool contains(const T &element) const;
 
+        // the number of elements equal to element
+        size_t count(const T &element) const;
+
+        // keep a hash index of the elements, so contains() is O(1) and remove() only visits the matches
+        void setHashIndex(bool enabled);
+
+        // whether a hash index is kept
+        bool hasHashIndex() const;
+
+        // keep the ascending view of a large container in Eytzinger order too, for faster range queries and contains()
+        void setEytzingerLayout(bool enabled);
+
+        // whether the Eytzinger layout is used
+        bool hasEytzingerLayout() const;
+
         // friend function to print the container
-        friend ostream &operator<<(ostream &os, const MyContainer<T> &container) {
+        friend ostream &operator<<(ostream &os, const MyContainer &container) {
             os << "[";
             for (size_t i = 0; i < container._size; ++i) {
                 os << container.elements[i];
@@ -77,6 +367,8 @@ namespace MyContainerNamespace {
             return os;
         }
 
+        class View;
+
         /**
          * Class Iterator
          * This class provides an iterator for the MyContainer class.
@@ -85,15 +377,36 @@ namespace MyContainerNamespace {
          */
         class Iterator {
         private:
-            T *start; // pointer to the start of the container
-            T *current; // pointer to the current element
-            T *end; // pointer to the end of the container
+            // How a position in the traversal maps to an element of data
+            enum Mapping { InOrder, Narrow, Wide, Reversed, MiddleOut };
+
+            T *data; // the elements, or the copies in an ordered view
+            const void *order; // uint32_t (Narrow) or uint64_t (Wide) indices into data, one per position
+            Mapping mapping;
+            bool sideCross = false; // positions alternate between the two ends of the sequence
+            size_t position; // the current position
+            size_t count; // number of positions, position == count is the end
+            LazySort *lazy = nullptr; // sorts order up to a position before it is read
+            const void *traversal = nullptr; // the cached view or lazy sort walked, nullptr for the elements themselves
+            bool plain = false; // straight over the elements on the container's thread, counted in elementIterators
 
-            MyContainer<T> *container;
+            MyContainer *container;
+
+            friend class MyContainer;
+            friend class View;
+
+            Iterator(MyContainer *container, T *data, const void *order, Mapping mapping, size_t position, size_t count,
+                     bool plain = false);
+
+            T *element(size_t at) const; // the element at a position
+
+            void track() const; // Count this iterator in its container, which refuses to add or remove while it lives
+
+            void untrack() const;
 
         public:
             // constructor and destructor
-            Iterator(MyContainer<T> *container, T *start, T *current, T *end);
+            Iterator(MyContainer *container, T *start, T *current, T *end);
 
             ~Iterator();
 
@@ -102,9 +415,9 @@ namespace MyContainerNamespace {
             Iterator(const Iterator &other);
 
             // operators for assignment
-            Iterator operator++();
+            Iterator &operator++();
 
-            Iterator operator--();
+            Iterator &operator--();
 
             Iterator operator++(int);
 
@@ -130,6 +443,14 @@ namespace MyContainerNamespace {
             T &operator[](size_t index) const;
         };
 
+    private:
+        Iterator viewIterator(const OrderedView &view, size_t position); // An iterator over a cached view
+
+        // Binary search of the ascending view: the first position whose element is not less than value,
+        // or greater than value when Upper
+        template<bool Upper>
+        size_t ascendingBound(const OrderedView &view, const T &value) const;
+
     public:
         Iterator begin();
 
@@ -165,302 +486,1936 @@ namespace MyContainerNamespace {
         Iterator beginSortedWith(Comparator comp);
 
         Iterator endSortedWith();
+
+        // sorted by key(element) with <, every key computed once instead of twice per comparison
+        template<typename KeyFn>
+        Iterator beginSortedBy(KeyFn key);
+
+        Iterator endSortedBy();
+
+        // ascending order sorted on demand: reading only the first k elements costs O(n + k log k)
+        Iterator beginLazyAscendingOrder();
+
+        Iterator endLazyAscendingOrder();
+
+        // first element of the ascending order not less than value, a binary search of the cached ascending view
+        Iterator lowerBound(const T &value);
+
+        // first element of the ascending order greater than value
+        Iterator upperBound(const T &value);
+
+        // the elements equal to value, the range [lowerBound(value), upperBound(value)) of the ascending order
+        std::pair<Iterator, Iterator> equalRange(const T &value);
+
+        // the number of elements in [lo, hi), two binary searches
+        size_t countInRange(const T &lo, const T &hi);
+
+        /**
+         * Class View
+         * One traversal order of the container as an object. begin() and end() can be called any number
+         * of times, and several views, of one order or of different ones, can be iterated at once,
+         * also from several threads. A view keeps its buffer alive and, like an iterator, blocks add()
+         * and remove() while it exists. It must not outlive the container.
+         */
+        class View {
+        private:
+            Iterator first; // at the start of the traversal, holds the order and pins the container
+
+            friend class MyContainer;
+
+            explicit View(const Iterator &first);
+
+        public:
+            Iterator begin() const;
+
+            Iterator end() const;
+
+            size_t size() const;
+
+            bool isEmpty() const;
+
+            // access the element at a position of the traversal
+            T &operator[](size_t index) const;
+        };
+
+        View inOrder();
+
+        View ascending();
+
+        View descending();
+
+        View sideCross();
+
+        View reverse();
+
+        View middleOut();
+
+        template<typename Comparator>
+        View sortedWith(Comparator comp);
+
+        template<typename KeyFn>
+        View sortedBy(KeyFn key);
+
+        View lazyAscending();
+
+        // the k largest elements, or the k first of the order of comp, in that order
+        template<typename Comparator = std::greater<T>>
+        View topK(size_t k, Comparator comp = Comparator());
+
+        View bottomK(size_t k); // the k smallest elements in ascending order
+
+        /**
+         * Class ExternalView
+         * The ascending order for containers whose sorted copy would not fit in memory. Chunks within a
+         * memory budget are sorted and spilled to temporary files, and begin() streams a k-way merge of
+         * them. Only the buffers within the budget are held, never a view of the whole container.
+         * The order can be traversed once. Like a View it blocks add() and remove() while it exists.
+         */
+        class ExternalView {
+        private:
+            // Copies of the elements when views hold copies, otherwise their indices
+            static constexpr bool holdsIndices = permutedViews || !std::is_default_constructible_v<T>;
+            using Record = std::conditional_t<holdsIndices, size_t, T>;
+
+            struct RecordLess {
+                const MyContainer *container;
+
+                bool operator()(const Record &a, const Record &b) const;
+            };
+
+            MyContainer *container;
+            std::unique_ptr<ExternalSort<Record, RecordLess>> sort;
+            std::optional<Record> current; // the record at position
+            size_t position = 0;
+            size_t count;
+
+            friend class MyContainer;
+
+            ExternalView(MyContainer *container, size_t memory_budget);
+
+            void advance(); // Take the next record of the merge
+
+        public:
+            // Single pass iterator over the merge
+            class Cursor {
+            private:
+                ExternalView *view;
+                size_t position;
+
+                friend class ExternalView;
+
+                Cursor(ExternalView *view, size_t position);
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T *;
+                using reference = const T &;
+
+                const T &operator*() const;
+
+                const T *operator->() const;
+
+                Cursor &operator++();
+
+                bool operator==(const Cursor &other) const;
+
+                bool operator!=(const Cursor &other) const;
+            };
+
+            ExternalView(ExternalView &&other) noexcept;
+
+            ExternalView(const ExternalView &) = delete;
+
+            ExternalView &operator=(const ExternalView &) = delete;
+
+            ExternalView &operator=(ExternalView &&) = delete;
+
+            ~ExternalView();
+
+            Cursor begin(); // where the traversal is now, the first element before it started
+
+            Cursor end();
+
+            size_t size() const;
+
+            size_t runCount() const; // runs spilled to files, 0 if the container fit in the budget
+
+            size_t peakMemory() const; // the most bytes the sort buffers held
+        };
+
+        // the ascending order sorted within memory_budget bytes, spilling to temporary files beyond it
+        ExternalView externalAscending(size_t memory_budget);
     };
 
     /**
-     * Change the capacity of the container
-     * @param new_capacity the new capacity of the container
+     * Allocate raw storage for elements, nothing is constructed in it.
+     * @param count number of elements the storage must hold
+     * @param scratch inline storage of InlineCapacity elements that is free to use, or nullptr
+     * @return the scratch if count fits in it, otherwise storage from the memory resource
+     * (nullptr when count is zero)
      */
-    template<typename T>
-    void MyContainer<T>::resize(size_t new_capacity) {
-        if (capacity == new_capacity) {
-            return; // No need to resize if the capacity is the same
-        }
-        T *new_elements = new T[new_capacity];
-        if (elements != nullptr) {
-            for (size_t i = 0; i < _size && i < new_capacity; ++i) {
-                new_elements[i] = elements[i];
-            }
-            delete[] elements;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T *MyContainer<T, InlineCapacity, GrowthPolicy>::allocate(const size_t count, T *scratch) const {
+        if (scratch != nullptr && count <= InlineCapacity) {
+            return scratch;
         }
-        elements = new_elements;
-        capacity = new_capacity;
-        // Adjust size if it exceeds new capacity
-        if (_size > new_capacity) {
-            _size = new_capacity;
+        if (count == 0) {
+            return nullptr;
         }
+        return std::pmr::polymorphic_allocator<T>(resource).allocate(count);
     }
 
-
     /**
-     * Constructor for MyContainer
+     * Free storage returned by allocate(), the elements in it must already be destroyed.
+     * @param buffer the storage to free
+     * @param count the number of elements it was allocated for
      */
-    template<typename T>
-    MyContainer<T>::MyContainer() : elements(nullptr), capacity(0), _size(0) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::deallocate(T *buffer, const size_t count) const {
+        // The inline buffer was never taken from the resource
+        if (buffer != nullptr && buffer != inlineElements.data()) {
+            std::pmr::polymorphic_allocator<T>(resource).deallocate(buffer, count);
+        }
     }
 
     /**
-     * Destructor for MyContainer
+     * Allocate raw storage for the slots of an ordered view, nothing is constructed in it.
+     * The inline view storage holds InlineCapacity elements, so it holds as many indices as well.
+     * @tparam Slot T for a view of copies, uint32_t or uint64_t for a view of indices
+     * @param count number of slots the storage must hold
+     * @param scratch the inline view storage when it is free to use, or nullptr
+     * @return the scratch if count fits in it, otherwise storage from the memory resource
+     * (nullptr when count is zero)
      */
-    template<typename T>
-    MyContainer<T>::~MyContainer() {
-        delete [] orderedCopy;
-        delete[] elements;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::allocateSlots(const size_t count, void *scratch) const {
+        constexpr bool fits = sizeof(Slot) <= sizeof(T) && alignof(Slot) <= alignof(T);
+        if (fits && scratch != nullptr && count <= InlineCapacity) {
+            return static_cast<Slot *>(scratch);
+        }
+        if (count == 0) {
+            return nullptr;
+        }
+        return std::pmr::polymorphic_allocator<Slot>(resource).allocate(count);
     }
 
     /**
-     * Copy constructor for MyContainer
-     * @param other myContainer to copy from
+     * Free storage returned by allocateSlots(), the slots in it must already be destroyed.
+     * @param slots the storage to free
+     * @param count the number of slots it was allocated for
      */
-    template<typename T>
-    MyContainer<T>::MyContainer(const MyContainer<T> &other) {
-        this->_size = other._size;
-        this->capacity = other.capacity;
-        this->elements = new T[other.capacity];
-        // Copy elements from the other container
-        for (size_t i = 0; i < other._size; ++i) {
-            this->elements[i] = other.elements[i];
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::deallocateSlots(Slot *slots, const size_t count) const {
+        if (slots != nullptr && static_cast<const void *>(slots) != inlineView.data()) {
+            std::pmr::polymorphic_allocator<Slot>(resource).deallocate(slots, count);
         }
     }
 
     /**
-     * Copy assignment operator for MyContainer
-     * @param other myContainer to copy from
-     * @return reference to this container
+     * Call fn with a view buffer cast to the slot type: T when views hold copies,
+     * otherwise uint32_t or uint64_t depending on wide.
+     * @param wide the view holds 64-bit indices
+     * @param buffer the slots, nullptr to only pick the type
+     * @param fn a generic callable taking a Slot pointer
      */
-    template<typename T>
-    MyContainer<T> &MyContainer<T>::operator=(const MyContainer<T> &other) {
-        if (this != &other) {
-            delete[] this->elements; // free existing elements
-            // overwrite with other's elements
-            this->_size = other._size;
-            this->capacity = other.capacity;
-            this->elements = new T[other.capacity];
-            // Copy elements from the other container
-            for (size_t i = 0; i < other._size; ++i) {
-                this->elements[i] = other.elements[i];
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Fn>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::withSlots(const bool wide, void *buffer, Fn fn) const {
+        if constexpr (permutedViews) {
+            if (wide) {
+                fn(static_cast<uint64_t *>(buffer));
+            } else {
+                fn(static_cast<uint32_t *>(buffer));
             }
+        } else {
+            (void) wide;
+            fn(static_cast<T *>(buffer));
         }
-        return *this;
     }
 
     /**
-     * Add an element to the container.
-     * @param element the element to add
+     * @return true if a view of the current elements needs 64-bit indices
      */
-    template<typename T>
-    void MyContainer<T>::add(const T &element) {
-        if (activeIterators > 0) {
-            throw ActiveIterator("Cannot modify container during iteration");
-        }
-        if (_size == capacity) {
-            // If the container is full, resize it to double the current \n
-            // capacity, faster runtime when adding elements
-            const size_t new_capacity = (capacity == 0) ? 1 : capacity * 2;
-            resize(new_capacity);
-        }
-        this->elements[this->_size++] = element;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::wideIndices() const {
+        return permutedViews && _size > std::numeric_limits<uint32_t>::max();
     }
 
     /**
-     * Remove an element from the container.
-     * If there are multiple instances of the element, remove all of them.
-     * If the element is not found, throw an exception.
-     * @param element the element to remove
+     * @param slot a slot of an ordered view
+     * @return the element the slot stands for
      */
-    template<typename T>
-    void MyContainer<T>::remove(const T &element) {
-        if (activeIterators > 0) {
-            throw ActiveIterator("Cannot modify container during iteration");
-        }
-        size_t new_size = 0;
-        bool found = false;
-
-        for (size_t i = 0; i < _size; ++i) {
-            if (elements[i] != element) {
-                elements[new_size++] = elements[i]; // Keep the element
-            } else {
-                found = true; // An element was found and will be removed
-            }
-        }
-
-        if (!found) {
-            throw ElementNotFound("Element not found in the container.");
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    const T &MyContainer<T, InlineCapacity, GrowthPolicy>::slotValue(const Slot &slot) const {
+        if constexpr (permutedViews) {
+            return elements[slot];
+        } else {
+            return slot;
         }
+    }
 
-        _size = new_size;
-
-        // Shrink if too much unused space
-        if (_size < capacity / 4 && capacity > 1) {
-            resize(capacity / 2);
-        }
-        // If the size is zero, free the memory and reset capacity
-        if (_size == 0) {
-            delete[] elements;
-            elements = nullptr;
-            capacity = 0;
+    /**
+     * Construct the slot standing for an element, a copy of it or its index.
+     * @param dest uninitialized storage for the slot
+     * @param index the index of the element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::constructSlot(Slot *dest, const size_t index) const {
+        if constexpr (permutedViews) {
+            ::new(static_cast<void *>(dest)) Slot(static_cast<Slot>(index));
+        } else {
+            ::new(static_cast<void *>(dest)) T(elements[index]);
         }
     }
 
-
     /**
-     * Provides access to the element at the specified index.
-     * If the index is out of bounds, throw an exception.
-     * @param index the index of the element to access
-     * @return a reference to the element at the specified index
+     * Construct count elements in uninitialized dest from source.
+     * Elements are moved when that cannot throw, otherwise they are copied so the source stays intact.
+     * @param source the elements to relocate
+     * @param count the number of elements
+     * @param dest uninitialized storage for count elements
      */
-    template<typename T>
-    T &MyContainer<T>::at(const size_t index) {
-        // Check if the index is within bounds
-        if (index > _size - 1) {
-            throw OutOfRange("Index out of range.");
-        }
-        if (_size == 0) {
-            throw ContainerEmpty("Container is empty.");
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::relocate(T *source, const size_t count, T *dest) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memcpy(static_cast<void *>(dest), source, count * sizeof(T));
+            }
+        } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move(source, source + count, dest);
+        } else {
+            std::uninitialized_copy(source, source + count, dest);
         }
-        return elements[index];
     }
 
     /**
-     * Returns the number of elements in the container.
+     * Destroy the live elements and free the element buffer, leaving the container empty.
      */
-    template<typename T>
-    size_t MyContainer<T>::size() const {
-        return this->_size;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::releaseElements() {
+        std::destroy(elements, elements + _size);
+        deallocate(elements, _capacity);
+        elements = inlineElements.data();
+        _capacity = InlineCapacity;
+        _size = 0;
     }
 
     /**
-     * Checks if the container is empty.
-     * @return true if the container is empty, false otherwise
+     * Destroy an ordered view buffer, the view must be built again before it is used.
+     * @param view the view to release
      */
-    template<typename T>
-    bool MyContainer<T>::isEmpty() const {
-        return this->_size == 0;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::releaseView(OrderedView &view) {
+        withSlots(view.wide, view.buffer, [this, &view](auto *slots) {
+            std::destroy(slots, slots + view.size);
+            deallocateSlots(slots, view.capacity);
+        });
+        view = OrderedView();
     }
 
     /**
-     * Checks if the container contains a specific element.
-     * @param element  the element to check for
-     * @return true if the element is found, false otherwise
+     * Take a view out of use. Its buffer is freed right away when no iterator is alive,
+     * otherwise it is kept until the iterators, which may point into it, are gone.
+     * @param view the view to retire, left empty
      */
-    template<typename T>
-    bool MyContainer<T>::contains(const T &element) const {
-        for (size_t i = 0; i < this->_size; ++i) {
-            if (elements[i] == element) {
-                return true;
-            }
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::retireView(OrderedView &view) {
+        if (activeIterators == 0 || view.buffer == nullptr) {
+            releaseView(view);
+            return;
         }
-        return false;
+        retiredViews.push_back(view);
+        view = OrderedView();
     }
 
     /**
-     * Private method to create a sorted copy of the container in ascending order.
-     * @return a pointer to a new array containing the sorted elements in ascending order
+     * Free the retired views, only called when no iterator is alive.
      */
-    template<typename T>
-    T *MyContainer<T>::createSortedCopyAscending() const {
-        T *sorted = new T[_size];
-        copy(elements, elements + _size, sorted);
-        sort(sorted, sorted + _size);
-        return sorted;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::releaseRetiredViews() {
+        for (OrderedView &view : retiredViews) {
+            releaseView(view);
+        }
+        retiredViews.clear();
+        for (auto &lazy : retiredLazySorts) {
+            releaseLazySort(*lazy);
+        }
+        retiredLazySorts.clear();
     }
 
     /**
-     * Private method to create a sorted copy of the container in descending order.
-     * @return a pointer to a new array containing the sorted elements in descending order
+     * Free the index buffer of a lazy sort.
+     * @param lazy the lazy sort
      */
-    template<typename T>
-    T *MyContainer<T>::createSortedCopyDescending() const {
-        T *sorted = new T[_size];
-        copy(elements, elements + _size, sorted);
-        sort(sorted, sorted + _size, greater<T>());
-        return sorted;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::releaseLazySort(LazySort &lazy) {
+        if (lazy.wide) {
+            deallocateSlots(static_cast<uint64_t *>(lazy.indices), lazy.size);
+        } else {
+            deallocateSlots(static_cast<uint32_t *>(lazy.indices), lazy.size);
+        }
+        lazy.indices = nullptr;
     }
 
     /**
-     * Private method to create a reverse copy of the container.
-     * @return a pointer to a new array containing the elements in reverse order
+     * Returns the lazy sort of the current elements. A new one costs O(n): the identity permutation,
+     * nothing is compared until it is read. A stale one is retired like a view.
+     * @return the lazy sort
      */
-    template<typename T>
-    T *MyContainer<T>::createReverseCopy() const {
-        T *reversed = new T[_size];
-        for (size_t i = 0; i < _size; ++i) {
-            reversed[i] = elements[_size - 1 - i];
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::LazySort &MyContainer<T, InlineCapacity, GrowthPolicy>::cachedLazySort() {
+        if (activeIterators == 0) {
+            releaseRetiredViews();
+        }
+        if (lazySort && lazySort->generation == generation) {
+            return *lazySort;
+        }
+        if (lazySort && activeIterators > 0) {
+            retiredLazySorts.push_back(std::move(lazySort));
+        } else if (lazySort) {
+            releaseLazySort(*lazySort);
         }
-        return reversed;
+        auto lazy = std::make_unique<LazySort>();
+        lazy->size = _size;
+        lazy->wide = _size > std::numeric_limits<uint32_t>::max();
+        if (lazy->wide) {
+            auto *indices = allocateSlots<uint64_t>(_size, nullptr);
+            std::iota(indices, indices + _size, uint64_t{0});
+            lazy->indices = indices;
+        } else {
+            auto *indices = allocateSlots<uint32_t>(_size, nullptr);
+            std::iota(indices, indices + _size, uint32_t{0});
+            lazy->indices = indices;
+        }
+        lazy->pivots.push_back(_size);
+        lazy->generation = generation;
+        lazy->structure = structure;
+        lazySort = std::move(lazy);
+        return *lazySort;
     }
 
     /**
-     * Private method to create a side cross copy of the container.
-     * @return  a pointer to a new array containing the elements inside cross-order
+     * Sort a lazy sort until a position holds its final element, under the view lock since
+     * several iterators, maybe on several threads, share it.
+     * @param lazy the lazy sort
+     * @param position the position about to be read
      */
-    template<typename T>
-    T *MyContainer<T>::createSideCrossCopy() const {
-        T *sorted = new T[_size];
-        copy(elements, elements + _size, sorted);
-        sort(sorted, sorted + _size);
-
-        T *result = new T[_size];
-        size_t left = 0, right = _size - 1, idx = 0;
-        while (left <= right) {
-            result[idx++] = sorted[left++];
-            if (left <= right) result[idx++] = sorted[right--];
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::settleLazy(LazySort &lazy, const size_t position) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        if (lazy.wide) {
+            settleLazyWith<uint64_t>(lazy, position);
+        } else {
+            settleLazyWith<uint32_t>(lazy, position);
         }
-
-        delete[] sorted;
-        return result;
     }
 
     /**
-     * Private method to create a middle out copy of the container.
-     * @return a pointer to a new array containing the elements in middle out order
+     * Incremental quicksort: the segment holding the next unsettled position is partitioned
+     * until that position is a pivot, the pivots to the right are kept on a stack for the following
+     * positions. Reading the first k elements costs O(n + k log k) on average.
+     * @tparam Index the index type of the lazy sort
+     * @param lazy the lazy sort
+     * @param position the position that must be final
      */
-    template<typename T>
-    T *MyContainer<T>::createMiddleOutCopy() const {
-        T *result = new T[_size];
-        size_t mid = _size / 2;
-        result[0] = elements[mid];
-
-        size_t left = mid;
-        size_t right = mid + 1;
-        size_t idx = 1;
-
-        while (left > 0 || right < _size) {
-            if (right < _size) result[idx++] = elements[right++];
-            if (left > 0) result[idx++] = elements[--left];
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Index>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::settleLazyWith(LazySort &lazy, const size_t position) {
+        constexpr size_t small_segment = 16;
+        Index *const indices = static_cast<Index *>(lazy.indices);
+        const auto less = [this](Index a, Index b) {
+            return elements[a] < elements[b] || (!(elements[b] < elements[a]) && a < b);
+        };
+        size_t settled = lazy.settled.load(std::memory_order_relaxed);
+        while (settled <= position) {
+            const size_t top = lazy.pivots.back();
+            if (settled == top) {
+                // Reached a pivot, it is already in place
+                lazy.pivots.pop_back();
+                ++settled;
+            } else if (top - settled <= small_segment) {
+                std::sort(indices + settled, indices + top, less);
+                lazy.pivots.pop_back();
+                settled = top < lazy.size ? top + 1 : top;
+            } else {
+                // Median of three as the pivot, moved to the end of the segment while partitioning
+                Index *const first = indices + settled;
+                Index *const last = indices + top - 1;
+                Index *const mid = first + (top - settled) / 2;
+                if (less(*mid, *first)) std::iter_swap(mid, first);
+                if (less(*last, *first)) std::iter_swap(last, first);
+                if (less(*mid, *last)) std::iter_swap(mid, last);
+                const Index pivot = *last;
+                Index *const split = std::partition(first, last, [&less, pivot](Index index) {
+                    return less(index, pivot);
+                });
+                std::iter_swap(split, last);
+                lazy.pivots.push_back(static_cast<size_t>(split - indices));
+            }
+        }
+        lazy.settled.store(settled, std::memory_order_release);
+    }
+
+    /**
+     * Make a buffer holding the _size slots of the current generation the content of a view.
+     * @param view the (released) view
+     * @param buffer the slots returned by one of the create functions
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::adoptView(OrderedView &view, void *buffer) {
+        view.buffer = buffer;
+        view.size = _size;
+        view.capacity = (buffer != nullptr && buffer == inlineView.data()) ? InlineCapacity : _size;
+        view.generation = generation;
+        view.structure = structure;
+        view.wide = wideIndices();
+        view.built = true;
+    }
+
+    /**
+     * Small views are cheap to rebuild, so the view occupying the inline storage is dropped
+     * to make room, unless iterators are alive and may point into it.
+     * @return the inline view storage for a view of _size elements, nullptr if it cannot be used
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void *MyContainer<T, InlineCapacity, GrowthPolicy>::viewScratch() {
+        T *scratch = inlineView.data();
+        if (scratch == nullptr || _size > InlineCapacity) {
+            return nullptr;
+        }
+        if (activeIterators == 0) {
+            releaseRetiredViews();
+            if (customView.buffer == scratch) {
+                releaseView(customView);
+            }
+            for (OrderedView &view : views) {
+                if (view.buffer == scratch) {
+                    releaseView(view);
+                }
+            }
+            return scratch;
+        }
+        if (customView.buffer == scratch) {
+            return nullptr;
+        }
+        for (const OrderedView &view : views) {
+            if (view.buffer == scratch) {
+                return nullptr;
+            }
+        }
+        for (const OrderedView &view : retiredViews) {
+            if (view.buffer == scratch) {
+                return nullptr;
+            }
+        }
+        return scratch;
+    }
+
+    /**
+     * Called when the elements can be written in place (at(), begin()...), no view can be reused
+     * or updated incrementally after that. Only the generation is bumped, without the view lock and
+     * without a read-modify-write, so plain loops stay cheap: two writers racing still both leave it
+     * past every view built before. settleWrites() drops the rest when it is next needed, and the
+     * next lookup rebuilds the hash index.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::markWritten() {
+        generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        hashIndexWritten.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * If elements may have been written in place since the ascending index and the run flags were
+     * last checked, neither holds any more: the index is sorted again and only an empty container
+     * is known to be in order. Called under the view lock or by adds and removes.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::settleWrites() {
+        const size_t current = generation.load(std::memory_order_relaxed);
+        if (trackedGeneration != current) {
+            ascendingIndexed = false;
+            inAscendingRun = _size == 0;
+            inDescendingRun = _size == 0;
+            trackedGeneration = current;
+        }
+    }
+
+    /**
+     * Called by adds and removes, with no iterator alive: the views are stale, while the ascending
+     * index and the run flags are kept up to date by the caller.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::markChanged() {
+        settleWrites();
+        const size_t next = generation.load(std::memory_order_relaxed) + 1;
+        generation.store(next, std::memory_order_relaxed);
+        trackedGeneration = next;
+        ++structure;
+    }
+
+    /**
+     * Iterators of ordered views and views may live on other threads and are counted atomically,
+     * iterators straight over the elements only on the container's own thread.
+     * @return whether any of them is alive
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::iterating() const {
+        return elementIterators > 0 || activeIterators > 0;
+    }
+
+    /**
+     * Keep the run flags up to date after elements were added at the end: each new element is compared
+     * with the one before it while either flag still holds, so data that is not in order costs nothing.
+     * A fresh hash index counts the new elements too.
+     * @param first the index of the first new element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::noteAppended(const size_t first) {
+        if constexpr (HasLess<T>::value) {
+            try {
+                for (size_t i = std::max<size_t>(first, 1); i < _size && (inAscendingRun || inDescendingRun); ++i) {
+                    const bool descends = elements[i] < elements[i - 1];
+                    inAscendingRun = inAscendingRun && !descends;
+                    inDescendingRun = inDescendingRun && descends;
+                }
+            } catch (...) {
+                // The elements are added already, a throwing comparison only costs the flags
+                inAscendingRun = inDescendingRun = false;
+            }
+        } else {
+            (void) first;
+            inAscendingRun = inDescendingRun = false;
+        }
+        if constexpr (Hashable<T>::value) {
+            if (hashIndexFresh.load(std::memory_order_relaxed)) {
+                try {
+                    for (size_t i = first; i < _size; ++i) {
+                        hashIndex.add(elements[i], i);
+                    }
+                } catch (...) {
+                    // A throwing hash, == or copy leaves the index behind the elements, the next lookup rebuilds it
+                    hashIndexFresh = false;
+                }
+            }
+        }
+    }
+
+    /**
+     * The hash index is rebuilt here, under the view lock, when it fell behind the elements or a
+     * writable reference to them was handed out since; concurrent lookups wait for the rebuild.
+     * @return true if the hash index is enabled and now counts exactly the elements
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::freshHashIndex() const {
+        if constexpr (Hashable<T>::value) {
+            if (!hashIndexEnabled) {
+                return false;
+            }
+            if (hashIndexFresh.load(std::memory_order_acquire) && !hashIndexWritten.load(std::memory_order_relaxed)) {
+                return true;
+            }
+            std::lock_guard<std::mutex> lock(viewMutex);
+            if (hashIndexWritten.load(std::memory_order_relaxed)) {
+                hashIndexWritten.store(false, std::memory_order_relaxed);
+                hashIndexFresh.store(false, std::memory_order_relaxed);
+            }
+            if (!hashIndexFresh.load(std::memory_order_relaxed)) {
+                hashIndex.clear();
+                hashIndex.reserve(_size);
+                for (size_t i = 0; i < _size; ++i) {
+                    hashIndex.add(elements[i], i);
+                }
+                hashIndexFresh.store(true, std::memory_order_release);
+            }
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Stable sort of view slots. Data made of few runs is merged run by run, O(n) when already
+     * sorted either way; otherwise numbers go to arithmeticSort and the rest to ParallelSort, which
+     * only gets a user comparator if ParallelSort::setUserComparators(true) allows it.
+     * @param first the first slot
+     * @param last one past the last slot
+     * @param comp the comparator on elements
+     * @param less comp on slots
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename Comparator, typename SlotLess>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::sortSlots(Slot *first, Slot *last, Comparator comp, SlotLess less) const {
+        if (RunSort::sort(first, last, less)) {
+            return;
+        }
+        if (arithmeticSort(first, last, comp)) {
+            return;
+        }
+        constexpr bool builtIn = std::is_same_v<Comparator, std::less<T>> || std::is_same_v<Comparator, std::greater<T>>;
+        if (builtIn || ParallelSort::userComparators()) {
+            ParallelSort::stableSort(first, last, less);
+        } else {
+            std::stable_sort(first, last, less);
+        }
+    }
+
+    /**
+     * Bring the ascending index up to date with the elements added after it was built:
+     * the k new elements are put behind the n indexed ones, sorted, and merged in,
+     * O(n + k log k) instead of sorting everything again. Only called when no iterator is alive.
+     * @tparam Slot the slot type of the index
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::mergeIntoIndex() {
+        OrderedView &index = views[Ascending];
+        const size_t indexed = index.size;
+        if (index.capacity < _size) {
+            // Grow geometrically like the elements, so a stream of small batches reallocates rarely
+            const size_t new_capacity = GrowthPolicy::grow(index.capacity, _size);
+            Slot *const old_slots = static_cast<Slot *>(index.buffer);
+            Slot *const slots = allocateSlots<Slot>(new_capacity, viewScratch());
+            try {
+                if constexpr (permutedViews) {
+                    std::uninitialized_copy(old_slots, old_slots + indexed, slots);
+                } else {
+                    relocate(old_slots, indexed, slots);
+                }
+            } catch (...) {
+                deallocateSlots(slots, new_capacity);
+                throw;
+            }
+            std::destroy(old_slots, old_slots + indexed);
+            deallocateSlots(old_slots, index.capacity);
+            index.buffer = slots;
+            index.capacity = (static_cast<void *>(slots) == inlineView.data()) ? InlineCapacity : new_capacity;
+        }
+        Slot *const slots = static_cast<Slot *>(index.buffer);
+        for (size_t i = indexed; i < _size; ++i) {
+            constructSlot(slots + i, i);
+            index.size = i + 1;
+        }
+
+        // A throwing comparison leaves the index unordered, it is rebuilt from scratch next time
+        ascendingIndexed = false;
+        const auto less = [this](const Slot &a, const Slot &b) { return slotValue(a) < slotValue(b); };
+        sortSlots(slots + indexed, slots + _size, std::less<T>(), less);
+        std::inplace_merge(slots, slots + indexed, slots + _size, less);
+        ascendingIndexed = true;
+        index.generation = generation;
+        index.structure = structure;
+    }
+
+    /**
+     * Remove the removed elements from the ascending index, nothing is sorted again.
+     * An index of copies drops the copies equal to the element, they sit together in its order.
+     * An index of indices drops the removed positions and renumbers the rest, as remove() shifted them.
+     * @tparam Slot the slot type of the index
+     * @param element the element remove() took out
+     * @param removed the positions, before compaction, of the removed elements, ascending
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::pruneIndex(const T &element, const std::vector<size_t> &removed) {
+        OrderedView &index = views[Ascending];
+        Slot *const first = static_cast<Slot *>(index.buffer);
+        Slot *const last = first + index.size;
+        ascendingIndexed = false;
+        Slot *new_last;
+        if constexpr (permutedViews) {
+            (void) element;
+            new_last = first;
+            for (const Slot *slot = first; slot != last; ++slot) {
+                const auto before = std::lower_bound(removed.begin(), removed.end(), static_cast<size_t>(*slot));
+                if (before != removed.end() && *before == *slot) {
+                    continue;
+                }
+                *new_last++ = static_cast<Slot>(*slot - static_cast<size_t>(before - removed.begin()));
+            }
+        } else {
+            const auto equal = std::equal_range(first, last, element);
+            Slot *const kept = std::remove_if(equal.first, equal.second, [&element](const T &value) {
+                return value == element;
+            });
+            new_last = std::move(equal.second, last, kept);
+        }
+        std::destroy(new_last, last);
+        const size_t pruned = static_cast<size_t>(last - new_last);
+        const size_t covered = static_cast<size_t>(std::lower_bound(removed.begin(), removed.end(), index.size) - removed.begin());
+        index.size -= pruned;
+        // If == and < disagree the index no longer mirrors the elements, rebuild it next time
+        ascendingIndexed = pruned == covered;
+    }
+
+    /**
+     * Returns the cached view of an order, building it first if it is missing or the container
+     * changed since it was built. The ascending view is updated incrementally when possible,
+     * descending is derived from it.
+     * @param kind the order of the view
+     * @return the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::OrderedView &
+    MyContainer<T, InlineCapacity, GrowthPolicy>::cachedView(const OrderKind kind) {
+        if (activeIterators == 0) {
+            releaseRetiredViews();
+        }
+        settleWrites();
+        OrderedView &view = views[kind];
+        if (view.built && view.generation == generation) {
+            return view;
+        }
+        if (kind == Ascending && view.built && ascendingIndexed && activeIterators == 0 && view.wide == wideIndices()) {
+            withSlots(view.wide, nullptr, [this](auto *type) {
+                this->template mergeIntoIndex<std::remove_pointer_t<decltype(type)>>();
+            });
+            return view;
+        }
+        retireView(view);
+        withSlots(wideIndices(), nullptr, [this, &view, kind](auto *type) {
+            this->template buildView<std::remove_pointer_t<decltype(type)>>(view, kind);
+        });
+        if (kind == Ascending) {
+            ascendingIndexed = true;
+        }
+        return view;
+    }
+
+    /**
+     * While iterators are alive, the view of an order is kept for its end iterators if elements were only
+     * written in place since it was built: a loop calling at() or begin() meets the end of the view it
+     * walks instead of sorting a new one every step. Otherwise this is cachedView().
+     * @param kind the order of the view
+     * @return the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::OrderedView &
+    MyContainer<T, InlineCapacity, GrowthPolicy>::endView(const OrderKind kind) {
+        OrderedView &view = views[kind];
+        if (activeIterators > 0 && view.built && view.structure == structure) {
+            return view;
+        }
+        return cachedView(kind);
+    }
+
+    /**
+     * Build a view from scratch.
+     * @tparam Slot the slot type of the views
+     * @param view the (released) view to build
+     * @param kind the order of the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::buildView(OrderedView &view, const OrderKind kind) {
+        Slot *slots;
+        if (kind == Descending && _size <= InlineCapacity) {
+            // Small: rank the elements on the stack rather than keep an ascending view next to this one
+            size_t ranks[InlineCapacity > 0 ? InlineCapacity : 1] = {};
+            for (size_t i = 0; i < _size; ++i) {
+                ranks[i] = i;
+            }
+            std::stable_sort(ranks, ranks + _size, [this](size_t a, size_t b) {
+                return elements[a] < elements[b];
+            });
+            const auto make = [this, &ranks](Slot *dest, size_t rank) { constructSlot(dest, ranks[rank]); };
+            const auto less = [this, &ranks](size_t a, size_t b) { return elements[ranks[a]] < elements[ranks[b]]; };
+            slots = createDescendingSlots<Slot>(make, less, viewScratch());
+        } else if (kind == Descending) {
+            // Only rearrange the ascending view, no second sort
+            const Slot *sorted = static_cast<const Slot *>(cachedView(Ascending).buffer);
+            const auto make = [sorted](Slot *dest, size_t rank) { ::new(static_cast<void *>(dest)) Slot(sorted[rank]); };
+            const auto less = [this, sorted](size_t a, size_t b) { return slotValue(sorted[a]) < slotValue(sorted[b]); };
+            slots = createDescendingSlots<Slot>(make, less, viewScratch());
+        } else {
+            slots = createSortedSlots<Slot>(std::less<T>(), viewScratch());
+        }
+        adoptView(view, slots);
+    }
+
+    /**
+     * Change the capacity of the container
+     * @param new_capacity the new capacity of the container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::resize(size_t new_capacity) {
+        // Never go below the inline capacity, the elements move back inside the object instead
+        if (new_capacity < InlineCapacity) {
+            new_capacity = InlineCapacity;
+        }
+        if (_capacity == new_capacity) {
+            return; // No need to resize if the capacity is the same
+        }
+        if (tryReallocate(new_capacity)) {
+            return;
+        }
+        // Elements past the new capacity are dropped
+        const size_t kept = _size < new_capacity ? _size : new_capacity;
+        T *new_elements = allocate(new_capacity, inlineElements.data());
+        try {
+            relocate(elements, kept, new_elements);
+        } catch (...) {
+            deallocate(new_elements, new_capacity);
+            throw;
+        }
+        std::destroy(elements, elements + _size);
+        deallocate(elements, _capacity);
+        elements = new_elements;
+        _capacity = new_capacity;
+        _size = kept;
+    }
+
+    /**
+     * Resize the element buffer with ReallocResource::reallocate(), which can grow it without copying.
+     * Only trivially copyable elements in a heap buffer of a ReallocResource qualify.
+     * @param new_capacity the new capacity, elements past it are dropped
+     * @return true if the buffer was resized, false if the caller must allocate and relocate
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::tryReallocate(const size_t new_capacity) {
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            return false;
+        } else {
+            // Inline buffers never came from the resource
+            if (_capacity <= InlineCapacity || new_capacity <= InlineCapacity) {
+                return false;
+            }
+            auto *reallocating = dynamic_cast<ReallocResource *>(resource);
+            if (reallocating == nullptr) {
+                return false;
+            }
+            elements = static_cast<T *>(reallocating->reallocate(elements, _capacity * sizeof(T),
+                                                                 new_capacity * sizeof(T), alignof(T)));
+            _capacity = new_capacity;
+            if (_size > new_capacity) {
+                _size = new_capacity;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * Constructor for MyContainer
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer() : MyContainer(std::pmr::get_default_resource()) {
+    }
+
+    /**
+     * Constructor for MyContainer that allocates from a memory resource
+     * @param resource the memory resource for the elements and the ordered views, must outlive the container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer(std::pmr::memory_resource *resource)
+        : resource(resource), elements(nullptr), _capacity(InlineCapacity), _size(0), hashIndex(resource), eytzinger(resource) {
+        elements = inlineElements.data();
+    }
+
+    /**
+     * Constructor for MyContainer from a range of elements
+     * @tparam InputIt the iterator type of the range
+     * @param first the first element to copy
+     * @param last one past the last element to copy
+     * @param resource the memory resource for the elements and the ordered views, must outlive the container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename InputIt, typename>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer(InputIt first, InputIt last,
+                                                              std::pmr::memory_resource *resource)
+        : MyContainer(resource) {
+        addRange(first, last);
+    }
+
+    /**
+     * Destructor for MyContainer, only the live elements are destroyed
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::~MyContainer() {
+        for (OrderedView &view : views) {
+            releaseView(view);
+        }
+        releaseView(customView);
+        releaseView(rankedView);
+        if (lazySort) {
+            releaseLazySort(*lazySort);
+        }
+        releaseRetiredViews();
+        releaseElements();
+    }
+
+    /**
+     * Copy constructor for MyContainer
+     * @param other myContainer to copy from
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer(const MyContainer<T, InlineCapacity, GrowthPolicy> &other)
+        : MyContainer(other, std::pmr::get_default_resource()) {
+    }
+
+    /**
+     * Copy constructor for MyContainer with a memory resource for the copy
+     * @param other myContainer to copy from
+     * @param resource the memory resource of the copy
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer(const MyContainer<T, InlineCapacity, GrowthPolicy> &other, std::pmr::memory_resource *resource)
+        : resource(resource), elements(nullptr), _capacity(other._capacity), _size(other._size),
+          inAscendingRun(other.inAscendingRun), inDescendingRun(other.inDescendingRun), hashIndex(resource),
+          hashIndexEnabled(other.hashIndexEnabled), eytzinger(resource), eytzingerEnabled(other.eytzingerEnabled) {
+        if (other.trackedGeneration != other.generation) {
+            // Written in place since the run flags were checked
+            inAscendingRun = inDescendingRun = _size == 0;
+        }
+        elements = allocate(_capacity, inlineElements.data());
+        // Copy elements from the other container
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            relocate(other.elements, _size, elements);
+            return;
+        }
+        try {
+            std::uninitialized_copy(other.elements, other.elements + other._size, elements);
+        } catch (...) {
+            deallocate(elements, _capacity);
+            throw;
+        }
+    }
+
+    /**
+     * Copy assignment operator for MyContainer
+     * @param other myContainer to copy from
+     * @return reference to this container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy> &MyContainer<T, InlineCapacity, GrowthPolicy>::operator=(const MyContainer<T, InlineCapacity, GrowthPolicy> &other) {
+        if (this != &other) {
+            // Copy first so this container is untouched if a copy throws
+            MyContainer<T, InlineCapacity, GrowthPolicy> copy(other, resource);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Move constructor for MyContainer
+     * @param other myContainer to move from, left empty
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::MyContainer(MyContainer<T, InlineCapacity, GrowthPolicy> &&other)
+        noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>)
+        : resource(other.resource), elements(other.elements), _capacity(other._capacity), _size(other._size),
+          inAscendingRun(other.inAscendingRun), inDescendingRun(other.inDescendingRun), hashIndex(other.resource),
+          hashIndexEnabled(other.hashIndexEnabled), eytzinger(other.resource), eytzingerEnabled(other.eytzingerEnabled) {
+        if (other.trackedGeneration != other.generation) {
+            // Written in place since the run flags were checked
+            inAscendingRun = inDescendingRun = _size == 0;
+        }
+        other.markWritten();
+        ++other.structure;
+        other.hashIndexFresh = false;
+        if (other._capacity <= InlineCapacity) {
+            // Inline elements live inside other, move them into our own inline storage
+            elements = inlineElements.data();
+            relocate(other.elements, other._size, elements);
+            other.releaseElements();
+            return;
+        }
+        other.elements = other.inlineElements.data();
+        other._capacity = InlineCapacity;
+        other._size = 0;
+    }
+
+    /**
+     * Move assignment operator for MyContainer
+     * @param other myContainer to move from, left empty
+     * @return reference to this container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy> &MyContainer<T, InlineCapacity, GrowthPolicy>::operator=(MyContainer<T, InlineCapacity, GrowthPolicy> &&other) {
+        if (this != &other) {
+            markWritten();
+            settleWrites(); // the index and the run flags were of the elements replaced
+            ++structure;
+            const bool checked = other.trackedGeneration == other.generation;
+            inAscendingRun = checked ? other.inAscendingRun : other._size == 0;
+            inDescendingRun = checked ? other.inDescendingRun : other._size == 0;
+            hashIndexEnabled = other.hashIndexEnabled;
+            eytzingerEnabled = other.eytzingerEnabled;
+            other.markWritten();
+            ++other.structure;
+            hashIndexFresh = false;
+            other.hashIndexFresh = false;
+            if (!resource->is_equal(*other.resource)) {
+                // The buffer cannot change resource, move the elements into storage from ours
+                const size_t new_capacity = std::max(other._size, InlineCapacity);
+                releaseElements();
+                T *new_elements = allocate(new_capacity, inlineElements.data());
+                try {
+                    relocate(other.elements, other._size, new_elements);
+                } catch (...) {
+                    deallocate(new_elements, new_capacity);
+                    throw;
+                }
+                elements = new_elements;
+                _capacity = new_capacity;
+                _size = other._size;
+                other.releaseElements();
+                return *this;
+            }
+            // free existing elements
+            releaseElements();
+            if (other._capacity <= InlineCapacity) {
+                // Inline elements cannot be stolen, move them into our own inline storage
+                relocate(other.elements, other._size, elements);
+                _size = other._size;
+                other.releaseElements();
+                return *this;
+            }
+            // take over other's buffer
+            this->elements = other.elements;
+            this->_capacity = other._capacity;
+            this->_size = other._size;
+            other.elements = other.inlineElements.data();
+            other._capacity = InlineCapacity;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @return the memory resource this container allocates from
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    std::pmr::memory_resource *MyContainer<T, InlineCapacity, GrowthPolicy>::getMemoryResource() const {
+        return resource;
+    }
+
+    /**
+     * Add an element to the container.
+     * @param element the element to add
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::add(const T &element) {
+        emplace(element);
+    }
+
+    /**
+     * Add an element to the container by moving it.
+     * @param element the element to move into the container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::add(T &&element) {
+        emplace(std::move(element));
+    }
+
+    /**
+     * Make room for count more elements and construct them at the end in one step.
+     * The new elements are constructed before the old ones are relocated, so the source may be
+     * part of this container.
+     * @tparam ConstructFn A callable constructing count elements in the uninitialized storage it gets,
+     * cleaning up after itself if it throws.
+     * @param count the number of new elements
+     * @param construct the callable that constructs them
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename ConstructFn>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::appendWith(const size_t count, ConstructFn construct) {
+        if (iterating()) {
+            throw ActiveIterator("Cannot modify container during iteration");
+        }
+        if (count == 0) {
+            return;
+        }
+        markChanged();
+        if (_size + count <= _capacity) {
+            construct(elements + _size);
+            _size += count;
+            noteAppended(_size - count);
+            return;
+        }
+        const size_t new_capacity = GrowthPolicy::grow(_capacity, _size + count);
+        T *new_elements = allocate(new_capacity, inlineElements.data());
+        try {
+            construct(new_elements + _size);
+        } catch (...) {
+            deallocate(new_elements, new_capacity);
+            throw;
+        }
+        try {
+            relocate(elements, _size, new_elements);
+        } catch (...) {
+            std::destroy(new_elements + _size, new_elements + _size + count);
+            deallocate(new_elements, new_capacity);
+            throw;
+        }
+        std::destroy(elements, elements + _size);
+        deallocate(elements, _capacity);
+        elements = new_elements;
+        _capacity = new_capacity;
+        _size += count;
+        noteAppended(_size - count);
+    }
+
+    /**
+     * Add every element of a range to the container.
+     * Forward ranges are measured first and need at most one reallocation,
+     * single-pass input ranges are added one element at a time.
+     * @tparam InputIt the iterator type of the range
+     * @param first the first element to add
+     * @param last one past the last element to add
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename InputIt>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::addRange(InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_pointer_v<InputIt> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>) {
+            append(first, static_cast<size_t>(last - first));
+        } else if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            const auto count = static_cast<size_t>(std::distance(first, last));
+            appendWith(count, [&](T *dest) { std::uninitialized_copy(first, last, dest); });
+        } else {
+            for (; first != last; ++first) {
+                emplace(*first);
+            }
+        }
+    }
+
+    /**
+     * Add all the listed elements to the container.
+     * @param values the elements to add
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::add(std::initializer_list<T> values) {
+        append(values.begin(), values.size());
+    }
+
+    /**
+     * Add count elements copied from a contiguous array.
+     * @param values pointer to the first element to copy, may point into this container
+     * @param count the number of elements to copy
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::append(const T *values, const size_t count) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (iterating()) {
+                throw ActiveIterator("Cannot modify container during iteration");
+            }
+            if (count == 0) {
+                return; // nothing changes, the views and the hash index stay
+            }
+            markChanged();
+            if (_size + count > _capacity) {
+                // Growing may move (or realloc) the buffer, so a source inside it is found again by offset
+                const std::less<const T *> before;
+                const bool inside = !before(values, elements) && before(values, elements + _size);
+                const size_t offset = inside ? static_cast<size_t>(values - elements) : 0;
+                resize(GrowthPolicy::grow(_capacity, _size + count));
+                if (inside) {
+                    values = elements + offset;
+                }
+            }
+            std::memcpy(static_cast<void *>(elements + _size), values, count * sizeof(T));
+            _size += count;
+            noteAppended(_size - count);
+        } else {
+            appendWith(count, [values, count](T *dest) {
+                std::uninitialized_copy(values, values + count, dest);
+            });
+        }
+    }
+
+    /**
+     * Construct an element at the end of the container.
+     * @tparam Args types of the constructor arguments
+     * @param args arguments forwarded to the constructor of T
+     * @return a reference to the new element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename... Args>
+    T &MyContainer<T, InlineCapacity, GrowthPolicy>::emplace(Args &&... args) {
+        if (iterating()) {
+            throw ActiveIterator("Cannot modify container during iteration");
+        }
+        markChanged();
+        if (_size < _capacity) {
+            T *slot = ::new(static_cast<void *>(elements + _size)) T(std::forward<Args>(args)...);
+            ++_size;
+            noteAppended(_size - 1);
+            return *slot;
+        }
+        // If the container is full, grow it geometrically (double by default) \n
+        // so adding n elements reallocates only O(log n) times
+        const size_t new_capacity = GrowthPolicy::grow(_capacity, _size + 1);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            // Take the value out first (the arguments may refer to an element), then let resize()
+            // memcpy the buffer or grow it in place
+            const T value(std::forward<Args>(args)...);
+            resize(new_capacity);
+            T *slot = ::new(static_cast<void *>(elements + _size)) T(value);
+            ++_size;
+            noteAppended(_size - 1);
+            return *slot;
+        }
+        T *new_elements = allocate(new_capacity, inlineElements.data());
+        // Build the new element before relocating, the arguments may refer to an old element
+        T *slot;
+        try {
+            slot = ::new(static_cast<void *>(new_elements + _size)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(new_elements, new_capacity);
+            throw;
+        }
+        try {
+            relocate(elements, _size, new_elements);
+        } catch (...) {
+            slot->~T();
+            deallocate(new_elements, new_capacity);
+            throw;
+        }
+        std::destroy(elements, elements + _size);
+        deallocate(elements, _capacity);
+        elements = new_elements;
+        _capacity = new_capacity;
+        ++_size;
+        noteAppended(_size - 1);
+        return *slot;
+    }
+
+    /**
+     * Remove an element from the container.
+     * If there are multiple instances of the element, remove all of them.
+     * If the element is not found, throw an exception.
+     * The matches are found with SimdSearch for numbers. With a hash index a missing element is reported
+     * without a scan, and the scan starts at the first match and stops after the last one, the elements
+     * behind it are only moved down.
+     * @param element the element to remove
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::remove(const T &element) {
+        if (iterating()) {
+            throw ActiveIterator("Cannot modify container during iteration");
+        }
+        settleWrites(); // the ascending index is only pruned if it still holds
+        size_t first = 0; // no element before it matches
+        size_t left = _size; // matches not found yet, at most
+        const typename HashIndex<T>::Entry *entry = nullptr;
+        if constexpr (Hashable<T>::value) {
+            if (freshHashIndex()) {
+                entry = hashIndex.find(element);
+                if (entry == nullptr) {
+                    throw ElementNotFound("Element not found in the container.");
+                }
+                first = hashIndex.firstPosition(*entry);
+                left = entry->count;
+            }
+        }
+        size_t new_size = first;
+        bool found = false;
+        const bool track = ascendingIndexed || entry != nullptr;
+        std::vector<size_t> removed; // positions of the removed elements, for the indexes
+
+        // Jump from match to match, the elements in between move down as a block
+        for (size_t i = first; i < _size;) {
+            const size_t match = left == 0 ? _size : indexOf(element, i);
+            if (new_size != i) {
+                std::move(elements + i, elements + match, elements + new_size); // Keep the elements
+            }
+            new_size += match - i;
+            if (match == _size) {
+                break;
+            }
+            found = true; // An element was found and will be removed
+            --left;
+            if (track) {
+                removed.push_back(match);
+            }
+            i = match + 1;
+        }
+
+        if (!found) {
+            throw ElementNotFound("Element not found in the container.");
+        }
+
+        markChanged();
+        if (ascendingIndexed) {
+            withSlots(views[Ascending].wide, nullptr, [this, &element, &removed](auto *type) {
+                this->template pruneIndex<std::remove_pointer_t<decltype(type)>>(element, removed);
+            });
+        }
+        if (entry != nullptr) {
+            // If the hash and == disagree the count was off, rebuild the index next time
+            hashIndexFresh = removed.size() == entry->count;
+            try {
+                hashIndex.erase(entry, removed.size());
+            } catch (...) {
+                hashIndexFresh = false; // a throwing move of a value, the elements are removed already
+            }
+            // Once a quarter as many elements were removed as are left, the first positions may lag far
+            // behind; a rebuild by the next lookup makes them exact again
+            if (hashIndex.removed() > new_size / 4) {
+                hashIndexFresh = false;
+            }
+        }
+        // Destroy the moved-from leftovers at the tail
+        std::destroy(elements + new_size, elements + _size);
+        _size = new_size;
+
+        // Shrink if the policy finds too much unused space, 0 frees the memory and resets capacity
+        const size_t new_capacity = GrowthPolicy::shrink(_size, _capacity);
+        if (new_capacity == 0) {
+            releaseElements();
+        } else {
+            resize(new_capacity);
+        }
+    }
+
+
+    /**
+     * Provides access to the element at the specified index.
+     * If the index is out of bounds, throw an exception.
+     * @param index the index of the element to access
+     * @return a reference to the element at the specified index
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T &MyContainer<T, InlineCapacity, GrowthPolicy>::at(const size_t index) {
+        const T &element = std::as_const(*this).at(index);
+        // The caller may write the element, cached views may go stale
+        markWritten();
+        return const_cast<T &>(element);
+    }
+
+    /**
+     * Write the element at an index. Unlike a write through at(), after which the next lookup rebuilds
+     * the hash index, a fresh index stays fresh: the old value is counted out of it and the new one in.
+     * If the index is out of bounds, throw an exception.
+     * @param index the index of the element to write
+     * @param value the new value
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::set(const size_t index, const T &value) {
+        const bool indexed = hashIndexFresh.load(std::memory_order_relaxed) &&
+                             !hashIndexWritten.load(std::memory_order_relaxed);
+        T &element = at(index);
+        if constexpr (Hashable<T>::value) {
+            if (indexed) {
+                hashIndexWritten.store(false, std::memory_order_relaxed); // only this element, counted below
+                hashIndexFresh = false; // until both values are counted, in case one throws
+                const auto *entry = hashIndex.find(element);
+                element = value;
+                if (entry == nullptr) {
+                    return; // the hash and == disagree, rebuild the index next time
+                }
+                hashIndex.discount(entry);
+                hashIndex.add(element, index);
+                hashIndexFresh = true;
+                return;
+            }
+        }
+        element = value;
+    }
+
+    /**
+     * Provides read-only access to the element at the specified index.
+     * If the index is out of bounds, throw an exception.
+     * @param index the index of the element to access
+     * @return a const reference to the element at the specified index
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    const T &MyContainer<T, InlineCapacity, GrowthPolicy>::at(const size_t index) const {
+        // Check if the index is within bounds
+        if (index > _size - 1) {
+            throw OutOfRange("Index out of range.");
+        }
+        if (_size == 0) {
+            throw ContainerEmpty("Container is empty.");
+        }
+        return elements[index];
+    }
+
+    /**
+     * Grow the capacity to at least new_capacity elements, never shrinks.
+     * @param new_capacity the number of elements that must fit without reallocating
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::reserve(const size_t new_capacity) {
+        if (new_capacity <= _capacity) {
+            return;
+        }
+        if (iterating()) {
+            throw ActiveIterator("Cannot reallocate container during iteration");
+        }
+        resize(new_capacity);
+    }
+
+    /**
+     * Reduce the capacity to the number of elements (or to the inline capacity, whichever is larger).
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::shrinkToFit() {
+        if (_capacity == _size || _capacity == InlineCapacity) {
+            return;
+        }
+        if (iterating()) {
+            throw ActiveIterator("Cannot reallocate container during iteration");
+        }
+        if (_size == 0) {
+            releaseElements();
+        } else {
+            resize(_size);
+        }
+    }
+
+    /**
+     * Returns the number of elements the container can hold before it reallocates.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::capacity() const {
+        return this->_capacity;
+    }
+
+    /**
+     * Returns the number of elements in the container.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::size() const {
+        return this->_size;
+    }
+
+    /**
+     * Checks if the container is empty.
+     * @return true if the container is empty, false otherwise
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::isEmpty() const {
+        return this->_size == 0;
+    }
+
+    /**
+     * Checks if the container contains a specific element.
+     * A hash lookup with a hash index, an Eytzinger search while an up to date ascending view exists and
+     * the layout is enabled, a (vector) scan otherwise.
+     * @param element  the element to check for
+     * @return true if the element is found, false otherwise
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::contains(const T &element) const {
+        if constexpr (Hashable<T>::value) {
+            if (freshHashIndex()) {
+                return hashIndex.find(element) != nullptr;
+            }
+        }
+        if constexpr (!permutedViews && HasLess<T>::value) {
+            if (eytzingerEnabled && _size >= eytzingerMinimum) {
+                const EytzingerLayout<T> *layout = &eytzinger;
+                if (layoutGeneration.load(std::memory_order_acquire) != generation) {
+                    std::lock_guard<std::mutex> lock(viewMutex);
+                    layout = freshLayout();
+                }
+                if (layout != nullptr) {
+                    return layout->contains(element);
+                }
+            }
+        }
+        return indexOf(element, 0) != _size;
+    }
+
+    /**
+     * Counts the elements equal to a value, a lookup with a hash index and a vector scan for numbers.
+     * @param element the value to count
+     * @return the number of elements equal to it
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::count(const T &element) const {
+        if constexpr (Hashable<T>::value) {
+            if (freshHashIndex()) {
+                const auto *entry = hashIndex.find(element);
+                return entry == nullptr ? 0 : entry->count;
+            }
+        }
+        if constexpr (SimdSearchable<T>::value) {
+            return SimdSearch::count(elements, elements + _size, element);
+        } else {
+            return static_cast<size_t>(std::count(elements, elements + _size, element));
+        }
+    }
+
+    /**
+     * @param value the value to look for
+     * @param from the position to start at
+     * @return the position of the first element equal to value at or after from, _size if there is none
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::indexOf(const T &value, const size_t from) const {
+        if constexpr (SimdSearchable<T>::value) {
+            return from + SimdSearch::find(elements + from, elements + _size, value);
+        } else {
+            for (size_t i = from; i < _size; ++i) {
+                if (elements[i] == value) {
+                    return i;
+                }
+            }
+            return _size;
+        }
+    }
+
+    /**
+     * Turn the hash index on or off. It is built on the first lookup and then kept up to date by every
+     * add, remove and set(). Handing out a writable reference (at(), begin(), find()...) makes the next
+     * lookup rebuild it, since reading through one looks the same as writing: write with set() and read
+     * through a const container to keep it.
+     * Copies and moved-to containers keep the setting.
+     * @param enabled whether to keep the index, false frees it
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::setHashIndex(const bool enabled) {
+        static_assert(Hashable<T>::value, "a hash index needs std::hash<T> and ==");
+        std::lock_guard<std::mutex> lock(viewMutex);
+        hashIndexEnabled = enabled;
+        hashIndexFresh = false;
+        if (!enabled) {
+            hashIndex.release();
+        }
+    }
+
+    /**
+     * @return true if the container keeps a hash index of its elements
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::hasHashIndex() const {
+        return hashIndexEnabled;
+    }
+
+    /**
+     * Turn the Eytzinger layout on or off. Once enabled, range queries on a container of at least
+     * eytzingerMinimum elements lay out the ascending view again after every change, O(n), and then
+     * search the layout; contains() uses it while it is up to date. Views of indices keep the flat
+     * search, comparing through the indices would miss the cache anyway.
+     * Copies and moved-to containers keep the setting.
+     * @param enabled whether to use the layout, false frees it
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::setEytzingerLayout(const bool enabled) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        eytzingerEnabled = enabled;
+        layoutGeneration = std::numeric_limits<size_t>::max();
+        eytzinger.release();
+    }
+
+    /**
+     * @return true if large ascending views are searched in Eytzinger order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::hasEytzingerLayout() const {
+        return eytzingerEnabled;
+    }
+
+    /**
+     * The layout is rebuilt from the ascending view when it mirrors an older generation; if the view is
+     * not up to date either, nothing is built and the caller searches another way.
+     * @return the layout of the current elements, nullptr if it is disabled, the container is small,
+     * the views hold indices or there is no up to date ascending view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    const EytzingerLayout<T> *MyContainer<T, InlineCapacity, GrowthPolicy>::freshLayout() const {
+        if constexpr (permutedViews) {
+            return nullptr;
+        } else {
+            if (!eytzingerEnabled || _size < eytzingerMinimum) {
+                return nullptr;
+            }
+            if (layoutGeneration.load(std::memory_order_acquire) == generation) {
+                return &eytzinger;
+            }
+            const OrderedView &view = views[Ascending];
+            if (!view.built || view.generation != generation || view.size != _size) {
+                return nullptr;
+            }
+            eytzinger.build(static_cast<const T *>(view.buffer), view.size);
+            layoutGeneration.store(generation, std::memory_order_release);
+            return &eytzinger;
+        }
+    }
+
+    /**
+     * Private method to create the slots of a view.
+     * @tparam Slot T for a view of copies, uint32_t or uint64_t for a view of indices
+     * @tparam MakeFn A callable constructing the slot for a position in the view, make(dest, position).
+     * @param make the callable
+     * @param scratch inline storage used instead of the memory resource when the view fits
+     * @return a pointer to a new buffer of _size slots, nullptr for an empty container
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename MakeFn>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::createSlots(MakeFn make, void *scratch) const {
+        Slot *result = allocateSlots<Slot>(_size, scratch);
+        size_t built = 0;
+        try {
+            for (; built < _size; ++built) {
+                make(result + built, built);
+            }
+        } catch (...) {
+            std::destroy(result, result + built);
+            deallocateSlots(result, _size);
+            throw;
+        }
+        return result;
+    }
+
+    /**
+     * Private method to create a view of the container in descending order from the ascending order.
+     * Equal elements keep their ascending (insertion) order, as a stable descending sort would.
+     * @tparam MakeFn A callable constructing the slot of the rank-th smallest element, make(dest, rank).
+     * @tparam LessFn A callable comparing the elements of two ranks.
+     * @param make the callable constructing slots
+     * @param less the callable comparing ranks
+     * @param scratch inline storage used instead of the memory resource when the view fits
+     * @return a pointer to a new buffer containing the slots in descending order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename MakeFn, typename LessFn>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::createDescendingSlots(MakeFn make, LessFn less, void *scratch) const {
+        Slot *result = allocateSlots<Slot>(_size, scratch);
+        size_t built = 0;
+        try {
+            // Walk the runs of equal elements from the largest down, each run front to back
+            size_t run_end = _size;
+            while (run_end > 0) {
+                size_t run_start = run_end - 1;
+                while (run_start > 0 && !less(run_start - 1, run_end - 1)) {
+                    --run_start;
+                }
+                for (size_t rank = run_start; rank < run_end; ++rank, ++built) {
+                    make(result + built, rank);
+                }
+                run_end = run_start;
+            }
+        } catch (...) {
+            std::destroy(result, result + built);
+            deallocateSlots(result, _size);
+            throw;
+        }
+        return result;
+    }
+
+    /**
+     * Creates a sorted view of the container using a custom comparator.
+     * @tparam Comparator A callable that defines the sort order.
+     * @param comp The comparator function or functor.
+     * @param scratch inline storage used instead of the memory resource when the view fits
+     * @return A pointer to the new buffer of sorted slots.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename Comparator>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::createSortedSlots(Comparator comp, void *scratch) const {
+        if constexpr (std::is_same_v<Comparator, std::less<T>>) {
+            // add() saw the elements arrive in order, or in reverse order without ties
+            if (inAscendingRun) {
+                return createSlots<Slot>([this](Slot *dest, size_t i) { constructSlot(dest, i); }, scratch);
+            }
+            if (inDescendingRun) {
+                return createSlots<Slot>([this](Slot *dest, size_t i) { constructSlot(dest, _size - 1 - i); }, scratch);
+            }
+        }
+        Slot *sorted = createSlots<Slot>([this](Slot *dest, size_t i) { constructSlot(dest, i); }, scratch);
+        try {
+            // Stable, so equal elements keep their insertion order
+            sortSlots(sorted, sorted + _size, comp, [this, &comp](const Slot &a, const Slot &b) {
+                return comp(slotValue(a), slotValue(b));
+            });
+        } catch (...) {
+            std::destroy(sorted, sorted + _size);
+            deallocateSlots(sorted, _size);
+            throw;
+        }
+        return sorted;
+    }
+
+
+    /**
+     * Creates the slots ordered by a key of their elements. Each key is extracted once into an array of
+     * (key, index) pairs, which is sorted instead of the elements, so an expensive key (a string returned
+     * by value, a computed field) costs n extractions rather than two per comparison. Keys whose < is
+     * not user code (numbers, pointers, std::string) are sorted in parallel, others like a user comparator.
+     * @tparam KeyFn a callable taking const T& and returning a key ordered by <
+     * @param key the key extractor
+     * @param scratch inline storage used instead of the memory resource when the view fits
+     * @return A pointer to the new buffer of sorted slots.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename KeyFn>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::createKeyedSlots(KeyFn key, void *scratch) const {
+        using Key = std::decay_t<std::invoke_result_t<KeyFn &, const T &>>;
+        std::pmr::vector<std::pair<Key, size_t>> keyed(resource);
+        keyed.reserve(_size);
+        for (size_t i = 0; i < _size; ++i) {
+            keyed.emplace_back(std::invoke(key, std::as_const(elements[i])), i);
+        }
+        // Stable, so elements with equal keys keep their insertion order
+        const auto less = [](const std::pair<Key, size_t> &a, const std::pair<Key, size_t> &b) {
+            return a.first < b.first;
+        };
+        constexpr bool builtIn = std::is_scalar_v<Key> || std::is_same_v<Key, std::string>;
+        if (builtIn || ParallelSort::userComparators()) {
+            ParallelSort::stableSort(keyed.begin(), keyed.end(), less);
+        } else {
+            std::stable_sort(keyed.begin(), keyed.end(), less);
+        }
+        return createSlots<Slot>([this, &keyed](Slot *dest, size_t rank) { constructSlot(dest, keyed[rank].second); }, scratch);
+    }
+
+    /**
+     * Sort copies of the elements without comparison branches. Below RadixSort::threshold the
+     * SimdSort kernels sort 32 and 64-bit elements, from there on the radix sort, O(n), takes
+     * every RadixSortable type. Only views holding copies qualify, with std::less or std::greater
+     * as the comparator.
+     * @param first the first slot
+     * @param last one past the last slot
+     * @param comp the comparator the caller would sort with
+     * @return true if the slots were sorted
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename Comparator>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::arithmeticSort(Slot *first, Slot *last, Comparator comp) const {
+        (void) comp;
+        constexpr bool ordered = std::is_same_v<Comparator, std::less<T>> || std::is_same_v<Comparator, std::greater<T>>;
+        if constexpr (std::is_same_v<Slot, T> && RadixSortable<T>::value && ordered) {
+            const size_t count = static_cast<size_t>(last - first);
+            constexpr bool descending = std::is_same_v<Comparator, std::greater<T>>;
+            if (count < RadixSort::threshold) {
+                // Reversing would swap -0.0 and 0.0, so floats only sort ascending with the kernels
+                if constexpr (SimdSortable<T>::value && (!descending || std::is_integral_v<T>)) {
+                    static_assert(RadixSort::threshold <= SimdSort::capacity, "the kernels take what radix sort does not");
+                    SimdSort::sort(first, last);
+                    if (descending) {
+                        std::reverse(first, last);
+                    }
+                    return true;
+                }
+                return false;
+            }
+            if constexpr (sizeof(T) == 1) {
+                RadixSort::sort(first, last, static_cast<T *>(nullptr), descending);
+            } else {
+                T *buffer = allocate(count, nullptr);
+                RadixSort::sort(first, last, buffer, descending);
+                deallocate(buffer, count);
+            }
+            return true;
+        } else {
+            (void) first;
+            (void) last;
+            return false;
+        }
+    }
+
+    /**
+     * Creates the first k slots of the order of a comparator without sorting the rest: a heap of the
+     * k best indices seen so far, whose top is the worst of them, is updated for every element.
+     * Ties are broken by the index, so the result is a prefix of the stable sort by comp.
+     * @tparam Comparator A callable that defines the sort order.
+     * @param k the number of slots, at most _size
+     * @param comp The comparator function or functor.
+     * @return A pointer to the new buffer of k slots, in the order of comp.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Slot, typename Comparator>
+    Slot *MyContainer<T, InlineCapacity, GrowthPolicy>::createBestSlots(const size_t k, Comparator comp) const {
+        const auto before = [this, &comp](size_t a, size_t b) {
+            if (comp(elements[a], elements[b])) return true;
+            return !comp(elements[b], elements[a]) && a < b;
+        };
+        size_t *best = allocateSlots<size_t>(k, nullptr);
+        Slot *result = nullptr;
+        try {
+            std::iota(best, best + k, size_t{0});
+            std::make_heap(best, best + k, before);
+            for (size_t i = k; i < _size && k > 0; ++i) {
+                // A later index never beats an equal element, so only strictly better ones get in
+                if (comp(elements[i], elements[best[0]])) {
+                    std::pop_heap(best, best + k, before);
+                    best[k - 1] = i;
+                    std::push_heap(best, best + k, before);
+                }
+            }
+            std::sort_heap(best, best + k, before);
+            result = allocateSlots<Slot>(k, nullptr);
+            size_t built = 0;
+            try {
+                for (; built < k; ++built) {
+                    constructSlot(result + built, best[built]);
+                }
+            } catch (...) {
+                std::destroy(result, result + built);
+                deallocateSlots(result, k);
+                throw;
+            }
+        } catch (...) {
+            deallocateSlots(best, k);
+            throw;
         }
-
+        deallocateSlots(best, k);
         return result;
     }
 
     /**
-     * Creates a sorted copy of the container using a custom comparator.
-     * @tparam Comparator A callable that defines the sort order.
-     * @param comp The comparator function or functor.
-     * @return A pointer to the newly sorted array.
+     * Constructor for Iterator over contiguous elements
+     * @param container Pointer to the parent container.
+     * @param start Pointer to the start of the container
+     * @param current Pointer to the current element in the container
+     * @param end Last element in the container (one past the last valid element)
      */
-    template<typename T>
-    template<typename Comparator>
-    T *MyContainer<T>::createSortedCopyWith(Comparator comp) const {
-        T *sorted = new T[_size];
-        std::copy(elements, elements + _size, sorted);
-        std::sort(sorted, sorted + _size, comp);
-        return sorted;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::Iterator(MyContainer<T, InlineCapacity, GrowthPolicy> *container, T *start, T *current, T *end)
+        : Iterator(container, start, nullptr, InOrder, static_cast<size_t>(current - start), static_cast<size_t>(end - start), true) {
     }
 
-
     /**
-     * Constructor for Iterator
+     * Constructor for Iterator over a traversal order
      * @param container Pointer to the parent container.
-     * @param start Pointer to the start of the container
-     * @param current Pointer to the current element in the container
-     * @param end Last element in the container (one past the last valid element)
+     * @param data the elements, or the copies in an ordered view
+     * @param order the indices into data for Narrow and Wide, nullptr for InOrder
+     * @param mapping how positions map to elements of data
+     * @param position the current position
+     * @param count the number of positions
+     * @param plain whether it only walks the elements on the container's thread, which is counted without atomics
      */
-    template<typename T>
-    MyContainer<T>::Iterator::Iterator(MyContainer<T> *container, T *start, T *current, T *end)
-        : start(start), current(current), end(end), container(container) {
-        if (container) {
-            container->activeIterators++;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::Iterator(MyContainer<T, InlineCapacity, GrowthPolicy> *container, T *data, const void *order,
+                                                                     const Mapping mapping, const size_t position, const size_t count,
+                                                                     const bool plain)
+        : data(data), order(order), mapping(mapping), position(position), count(count), plain(plain), container(container) {
+        track();
+    }
+
+    /**
+     * Plain iterators are counted with a plain integer, they cannot be shared with other threads,
+     * iterators of ordered views and views atomically.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::track() const {
+        if (container == nullptr) {
+            return;
+        }
+        if (plain) {
+            ++container->elementIterators;
+        } else {
+            ++container->activeIterators;
+        }
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::untrack() const {
+        if (container == nullptr) {
+            return;
+        }
+        if (plain) {
+            --container->elementIterators;
+        } else {
+            --container->activeIterators;
         }
     }
 
@@ -468,11 +2423,9 @@ namespace MyContainerNamespace {
     /**
      * Destructor for Iterator, only a pointer is deleted, no need to delete the elements
      */
-    template<typename T>
-    MyContainer<T>::Iterator::~Iterator() {
-        if (container) {
-            container->activeIterators--;
-        }
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::~Iterator() {
+        untrack();
     }
 
 
@@ -480,14 +2433,44 @@ namespace MyContainerNamespace {
      * Copy constructor for Iterator
      * @param other Iterator to copy from, only the pointers are copied
      */
-    template<typename T>
-    MyContainer<T>::Iterator::Iterator(const Iterator &other) {
-        this->container = other.container;
-        this->start = other.start;
-        this->current = other.current;
-        this->end = other.end;
-        if (container) {
-            container->activeIterators++;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::Iterator(const Iterator &other)
+        : data(other.data), order(other.order), mapping(other.mapping), sideCross(other.sideCross),
+          position(other.position), count(other.count), lazy(other.lazy), traversal(other.traversal),
+          plain(other.plain), container(other.container) {
+        track();
+    }
+
+    /**
+     * @param at a position of the traversal
+     * @return a pointer to the element at that position
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T *MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::element(size_t at) const {
+        if (sideCross) {
+            // Even positions walk up from the front (left cursor), odd ones down from the back (right cursor)
+            at = (at % 2 == 0) ? at / 2 : count - 1 - at / 2;
+        }
+        if (lazy != nullptr && at >= lazy->settled.load(std::memory_order_acquire)) {
+            container->settleLazy(*lazy, at);
+        }
+        switch (mapping) {
+            case Narrow: return data + static_cast<const uint32_t *>(order)[at];
+            case Wide: return data + static_cast<const uint64_t *>(order)[at];
+            case Reversed: return data + (count - 1 - at);
+            case MiddleOut: {
+                // Start at the middle, then alternate right and left, once a side runs out the other one continues
+                const size_t mid = count / 2;
+                if (at == 0) {
+                    return data + mid;
+                }
+                const size_t step = (at + 1) / 2;
+                if (at % 2 == 1 && mid + step < count) {
+                    return data + mid + step;
+                }
+                return data + (mid - step);
+            }
+            default: return data + at;
         }
     }
 
@@ -495,12 +2478,12 @@ namespace MyContainerNamespace {
      * Operator to increment the iterator to the next element.
      * @return a reference to the incremented iterator
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::Iterator::operator++() {
-        if (current == end) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator &MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator++() {
+        if (position == count) {
             throw OutOfRange("Iterator out of range!!.");
         }
-        ++current;
+        ++position;
         return *this;
     }
 
@@ -509,12 +2492,12 @@ namespace MyContainerNamespace {
      * Operator to decrement the iterator to the previous element.
      * @return a reference to the decremented iterator
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::Iterator::operator--() {
-        if (start == current) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator &MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator--() {
+        if (position == 0) {
             throw OutOfRange("Cannot decrement before the start of the container.");
         }
-        --current;
+        --position;
         return *this;
     }
 
@@ -522,9 +2505,9 @@ namespace MyContainerNamespace {
      * Postfix increment operator for the iterator (it++).
      * @return A copy of the iterator before it was incremented.
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::Iterator::operator++(int) {
-        if (current == end) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator++(int) {
+        if (position == count) {
             throw OutOfRange("Iterator out of range.");
         }
         Iterator tmp = *this;
@@ -536,9 +2519,9 @@ namespace MyContainerNamespace {
      * Postfix decrement operator for the iterator (it--).
      * @return A copy of the iterator before it was decremented.
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::Iterator::operator--(int) {
-        if (start == current) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator--(int) {
+        if (position == 0) {
             throw OutOfRange("Cannot decrement before the start of the container.");
         }
         Iterator tmp = *this;
@@ -551,19 +2534,21 @@ namespace MyContainerNamespace {
      * @param other Iterator to copy from
      * @return a reference to this iterator
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator &MyContainer<T>::Iterator::operator=(const Iterator &other) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator &MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator=(const Iterator &other) {
         if (this != &other) {
-            if (container) {
-                container->activeIterators--;
-            }
+            untrack();
             this->container = other.container;
-            this->start = other.start;
-            this->current = other.current;
-            this->end = other.end;
-            if (container) {
-                container->activeIterators++;
-            }
+            this->data = other.data;
+            this->order = other.order;
+            this->mapping = other.mapping;
+            this->sideCross = other.sideCross;
+            this->position = other.position;
+            this->count = other.count;
+            this->lazy = other.lazy;
+            this->traversal = other.traversal;
+            this->plain = other.plain;
+            track();
         }
         return *this;
     }
@@ -571,34 +2556,40 @@ namespace MyContainerNamespace {
 
     /**
      * Pointer operator to access the current element.
-     * @return a pointer to the current element
+     * @return a pointer to the current element, nullptr at the end
      */
-    template<typename T>
-    T *MyContainer<T>::Iterator::operator->() const {
-        return current;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T *MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator->() const {
+        return position < count ? element(position) : nullptr;
     }
 
     /**
      * Deference operator the iterator to access the current element.
      * @return
      */
-    template<typename T>
-    T &MyContainer<T>::Iterator::operator*() const {
-        if (current == nullptr || current == end) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T &MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator*() const {
+        if (data == nullptr || position == count) {
             throw OutOfRange("Cannot dereference end or null iterator.");
         }
-        return *current;
+        if (mapping == InOrder && !sideCross) {
+            return data[position]; // kept short so plain loops inline it
+        }
+        return *element(position);
     }
 
 
     /**
      * Operator to check if two iterators are equal.
+     * Iterators of one traversal compare by position, not by buffer, so an iterator still walks to the
+     * end made after its view was replaced.
      * @param other Iterator to compare with
-     * @return true if the iterators point to the same element, false otherwise
+     * @return true if the iterators are at the same position of the same traversal, false otherwise
      */
-    template<typename T>
-    bool MyContainer<T>::Iterator::operator==(const Iterator &other) const {
-        return current == other.current;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator==(const Iterator &other) const {
+        return position == other.position && container == other.container && traversal == other.traversal &&
+               mapping == other.mapping && sideCross == other.sideCross;
     }
 
     /**
@@ -606,8 +2597,8 @@ namespace MyContainerNamespace {
      * @param other Iterator to compare with
      * @return true if the iterators do not point to the same element, false otherwise
      */
-    template<typename T>
-    bool MyContainer<T>::Iterator::operator!=(const Iterator &other) const {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator!=(const Iterator &other) const {
         return !(*this == other);
     }
 
@@ -616,117 +2607,221 @@ namespace MyContainerNamespace {
      * @param index the index of the element to access
      * @return a reference to the element at the specified index
      */
-    template<typename T>
-    T &MyContainer<T>::Iterator::operator[](size_t index) const {
-        const size_t range = static_cast<size_t>(end - start);
-        if (index >= range) {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T &MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator::operator[](size_t index) const {
+        if (index >= count) {
             throw OutOfRange("Index out of range.");
         }
-        return *(start + index);
+        return *element(index);
+    }
+
+    /**
+     * @param view a cached view
+     * @param position the starting position, view.size for the end
+     * @return an iterator over the view, through its indices when it holds indices
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::viewIterator(const OrderedView &view, const size_t position) {
+        Iterator it = permutedViews
+                          ? Iterator(this, elements, view.buffer, view.wide ? Iterator::Wide : Iterator::Narrow, position, view.size)
+                          : Iterator(this, static_cast<T *>(view.buffer), nullptr, Iterator::InOrder, position, view.size);
+        it.traversal = &view;
+        return it;
     }
 
     /**
      * @return an iterator to the beginning of the container.
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::begin() {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::begin() {
+        // The elements can be written through the iterator, cached views may go stale
+        markWritten();
         return Iterator(this, &elements[0], &elements[0], &elements[_size]);
     }
 
     /**
      * @return an iterator to the end of the container.
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::end() {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::end() {
+        markWritten();
         return Iterator(this, &elements[0], &elements[_size], &elements[_size]);
     }
 
     /**
+     * The position is found first (a vector scan for numbers, starting at the first occurrence the
+     * hash index knows of when there is one), then a single iterator is made for it.
      * @param val The value to search for.
      * @return Iterator to the value if found, otherwise end().
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::find(const T &val) {
-        for (auto it = begin(); it != end(); ++it) {
-            if (*it == val) {
-                return it;
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::find(const T &val) {
+        size_t from = 0;
+        if constexpr (Hashable<T>::value) {
+            if (freshHashIndex()) {
+                const auto *entry = hashIndex.find(val);
+                from = entry == nullptr ? _size : hashIndex.firstPosition(*entry);
             }
         }
-        return end(); // Value not found
+        const size_t index = indexOf(val, from);
+        // The elements can be written through the iterator, cached views may go stale
+        markWritten();
+        return Iterator(this, &elements[0], &elements[index], &elements[_size]);
     }
 
     /**
      *
      * @return  an iterator to the beginning of the container in ascending order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginAscendingOrder() {
-        if (orderedCopy) {
-            delete[] orderedCopy;
-        }
-        orderedCopy = createSortedCopyAscending();
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginAscendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        return viewIterator(cachedView(Ascending), 0);
     }
 
     /**
      *
      * @return  an iterator to the end of the container in ascending order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endAscendingOrder() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endAscendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = endView(Ascending);
+        return viewIterator(view, view.size);
+    }
+
+    /**
+     * Searches the Eytzinger layout instead of the view when it is enabled and the container is large.
+     * @tparam Upper search for the first element greater than value instead of not less
+     * @param view the ascending view, up to date, with the view lock held
+     * @param value the value to search for
+     * @return a position in the view, view.size if every element is before value
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<bool Upper>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::ascendingBound(const OrderedView &view, const T &value) const {
+        if (const EytzingerLayout<T> *layout = freshLayout()) {
+            return Upper ? layout->upperBound(value) : layout->lowerBound(value);
+        }
+        size_t position = 0;
+        withSlots(view.wide, view.buffer, [this, &view, &value, &position](auto *slots) {
+            using Slot = std::remove_pointer_t<decltype(slots)>;
+            if constexpr (Upper) {
+                position = static_cast<size_t>(std::upper_bound(slots, slots + view.size, value, [this](const T &v, const Slot &slot) {
+                    return v < slotValue(slot);
+                }) - slots);
+            } else {
+                position = static_cast<size_t>(std::lower_bound(slots, slots + view.size, value, [this](const Slot &slot, const T &v) {
+                    return slotValue(slot) < v;
+                }) - slots);
+            }
+        });
+        return position;
+    }
+
+    /**
+     * Builds or updates the ascending view like beginAscendingOrder() when the container changed,
+     * afterwards every query is O(log n).
+     * @param value the value to search for
+     * @return an iterator over the ascending order at the first element not less than value,
+     * endAscendingOrder() if there is none
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::lowerBound(const T &value) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = cachedView(Ascending);
+        return viewIterator(view, ascendingBound<false>(view, value));
+    }
+
+    /**
+     * @param value the value to search for
+     * @return an iterator over the ascending order at the first element greater than value,
+     * endAscendingOrder() if there is none
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::upperBound(const T &value) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = cachedView(Ascending);
+        return viewIterator(view, ascendingBound<true>(view, value));
+    }
+
+    /**
+     * @param value the value to search for
+     * @return the iterators of lowerBound(value) and upperBound(value), equal if no element is equal to value
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    std::pair<typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator, typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::equalRange(const T &value) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = cachedView(Ascending);
+        return {viewIterator(view, ascendingBound<false>(view, value)), viewIterator(view, ascendingBound<true>(view, value))};
+    }
+
+    /**
+     * Counts the elements x with lo <= x < hi without traversing them.
+     * @param lo the lowest value counted
+     * @param hi the first value past the range
+     * @return the number of elements in [lo, hi), 0 if hi is not above lo
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::countInRange(const T &lo, const T &hi) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = cachedView(Ascending);
+        const size_t first = ascendingBound<false>(view, lo);
+        const size_t last = ascendingBound<false>(view, hi);
+        return last > first ? last - first : 0;
     }
 
     /**
      *
      * @return  an iterator to the beginning of the container in descending order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginDescendingOrder() {
-        if (orderedCopy) {
-            delete[] orderedCopy;
-        }
-        orderedCopy = createSortedCopyDescending();
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginDescendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        return viewIterator(cachedView(Descending), 0);
     }
 
     /**
      *
      * @return  an iterator to the end of the container in descending order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endDescendingOrder() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endDescendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = endView(Descending);
+        return viewIterator(view, view.size);
     }
 
     /**
      *
      * @return  an iterator to the beginning of the container in reverse order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginReverseOrder() {
-        if (orderedCopy) {
-            delete[] orderedCopy;
-        }
-        orderedCopy = createReverseCopy();
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginReverseOrder() {
+        // Computed from the index on the fly, nothing is copied, but the elements can be written through it
+        markWritten();
+        return Iterator(this, elements, nullptr, Iterator::Reversed, 0, _size, true);
     }
 
     /**
      *
      * @return  an iterator to the end of the container in reverse order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endReverseOrder() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endReverseOrder() {
+        markWritten();
+        return Iterator(this, elements, nullptr, Iterator::Reversed, _size, _size, true);
     }
 
     /**
      *
      * @return  an iterator to the beginning of the container in order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginOrder() {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginOrder() {
+        // The elements can be written through the iterator, cached views may go stale
+        markWritten();
         return Iterator(this, elements, elements, elements + _size);
     }
 
@@ -734,8 +2829,9 @@ namespace MyContainerNamespace {
      *
      * @return  an iterator to the end of the container in order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endOrder() {
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endOrder() {
+        markWritten();
         return Iterator(this, elements, elements + _size, elements + _size);
     }
 
@@ -743,66 +2839,461 @@ namespace MyContainerNamespace {
      *
      * @return  an iterator to the beginning of the container in side cross-order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginSideCrossOrder() {
-        if (orderedCopy) {
-            delete[] orderedCopy;
-        }
-        orderedCopy = createSideCrossCopy();
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginSideCrossOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        // Two cursors over the ascending view, no side cross copy is made
+        Iterator it = viewIterator(cachedView(Ascending), 0);
+        it.sideCross = true;
+        return it;
     }
 
     /**
      *
      * @return  an iterator to the end of the container inside cross-order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endSideCrossOrder() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endSideCrossOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        const OrderedView &view = endView(Ascending);
+        Iterator it = viewIterator(view, view.size);
+        it.sideCross = true;
+        return it;
     }
 
     /**
      *
      * @return  an iterator to the beginning of the container in middle out order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginMiddleOutOrder() {
-        if (orderedCopy) {
-            delete[] orderedCopy;
-        }
-        orderedCopy = createMiddleOutCopy();
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginMiddleOutOrder() {
+        // Computed from the index on the fly, nothing is copied, but the elements can be written through it
+        markWritten();
+        return Iterator(this, elements, nullptr, Iterator::MiddleOut, 0, _size, true);
     }
 
     /**
      *
      * @return an iterator to the end of the container in middle out order
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endMiddleOutOrder() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endMiddleOutOrder() {
+        markWritten();
+        return Iterator(this, elements, nullptr, Iterator::MiddleOut, _size, _size, true);
     }
 
     /**
      * Returns an iterator to the beginning of a sorted view using the given comparator.
+     * Large views are sorted on one thread, unless ParallelSort::setUserComparators(true) was called:
+     * then comp is called from several threads at once and must be safe for that (no unguarded shared
+     * state, no counters).
      * @tparam Comparator A callable that defines the sort order.
      * @param comp The comparator function or functor.
      * @return Iterator pointing to the first element of the sorted view.
      */
-    template<typename T>
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
     template<typename Comparator>
-    typename MyContainer<T>::Iterator MyContainer<T>::beginSortedWith(Comparator comp) {
-        if (orderedCopy) delete[] orderedCopy;
-        orderedCopy = createSortedCopyWith(comp);
-        return Iterator(this, orderedCopy, orderedCopy, orderedCopy + _size);
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginSortedWith(Comparator comp) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        settleWrites(); // the run flags are read by createSortedSlots
+        retireView(customView);
+        withSlots(wideIndices(), nullptr, [this, &comp](auto *type) {
+            using Slot = std::remove_pointer_t<decltype(type)>;
+            adoptView(customView, this->template createSortedSlots<Slot>(comp, viewScratch()));
+        });
+        return viewIterator(customView, 0);
+    }
+
+    /**
+     * Returns an iterator to the beginning of a view sorted by a key of the elements, e.g.
+     * beginSortedBy([](const People &p) { return p.getName(); }). Each key is computed once, on this
+     * thread. Keys of a user type are compared on one thread too, unless ParallelSort::setUserComparators(true)
+     * was called: then their < must be safe to call from several threads at once.
+     * @tparam KeyFn A callable taking const T& and returning a key ordered by <.
+     * @param key The key extractor.
+     * @return Iterator pointing to the element with the smallest key.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename KeyFn>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginSortedBy(KeyFn key) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        retireView(customView);
+        withSlots(wideIndices(), nullptr, [this, &key](auto *type) {
+            using Slot = std::remove_pointer_t<decltype(type)>;
+            adoptView(customView, this->template createKeyedSlots<Slot>(key, viewScratch()));
+        });
+        return viewIterator(customView, 0);
+    }
+
+    /**
+     * Returns an iterator to the end of the sorted view created with beginSortedBy.
+     * @return Iterator pointing past the last element of the sorted view.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endSortedBy() {
+        return endSortedWith();
     }
 
     /**
      * Returns an iterator to the end of the sorted view created with beginSortedWith.
      * @return Iterator pointing past the last element of the sorted view.
      */
-    template<typename T>
-    typename MyContainer<T>::Iterator MyContainer<T>::endSortedWith() {
-        return Iterator(this, orderedCopy, orderedCopy + _size, orderedCopy + _size);
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endSortedWith() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        return viewIterator(customView, customView.size);
+    }
+
+    /**
+     * Returns an iterator over the ascending order that sorts only as far as it is read,
+     * like a partial sort whose size is not known up front. Equal elements keep their insertion order.
+     * @return an iterator to the smallest element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::beginLazyAscendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        LazySort &lazy = cachedLazySort();
+        Iterator it(this, elements, lazy.indices, lazy.wide ? Iterator::Wide : Iterator::Narrow, 0, lazy.size);
+        it.lazy = &lazy;
+        it.traversal = &lazySort;
+        return it;
+    }
+
+    /**
+     * @return an iterator past the largest element of the lazy ascending order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::endLazyAscendingOrder() {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        // Like endView(), the lazy sort live iterators walk is kept if elements were only written in place
+        const bool walked = lazySort && activeIterators > 0 && lazySort->structure == structure;
+        LazySort &lazy = walked ? *lazySort : cachedLazySort();
+        Iterator it(this, elements, lazy.indices, lazy.wide ? Iterator::Wide : Iterator::Narrow, lazy.size, lazy.size);
+        it.lazy = &lazy;
+        it.traversal = &lazySort;
+        return it;
+    }
+
+    /**
+     * Constructor for View
+     * @param first an iterator at the start of the traversal
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::View::View(const Iterator &first) : first(first) {
+    }
+
+    /**
+     * @return an iterator to the first element of the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::View::begin() const {
+        return first;
+    }
+
+    /**
+     * @return an iterator past the last element of the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::Iterator MyContainer<T, InlineCapacity, GrowthPolicy>::View::end() const {
+        Iterator last = first;
+        last.position = last.count;
+        return last;
+    }
+
+    /**
+     * @return the number of elements in the view
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::View::size() const {
+        return first.count;
+    }
+
+    /**
+     * @return true if the view has no elements
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::View::isEmpty() const {
+        return first.count == 0;
+    }
+
+    /**
+     * Operator to access the element at a position of the view.
+     * @param index the position
+     * @return a reference to the element at that position
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    T &MyContainer<T, InlineCapacity, GrowthPolicy>::View::operator[](const size_t index) const {
+        return first[index];
+    }
+
+    /**
+     * @return a view of the container in insertion order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::inOrder() {
+        // A view may be walked on other threads, its iterators are counted atomically
+        markWritten();
+        return View(Iterator(this, elements, nullptr, Iterator::InOrder, 0, _size));
+    }
+
+    /**
+     * @return a view of the container in ascending order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::ascending() {
+        return View(beginAscendingOrder());
+    }
+
+    /**
+     * @return a view of the container in descending order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::descending() {
+        return View(beginDescendingOrder());
+    }
+
+    /**
+     * @return a view of the container in side cross-order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::sideCross() {
+        return View(beginSideCrossOrder());
+    }
+
+    /**
+     * @return a view of the container in reverse order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::reverse() {
+        markWritten();
+        return View(Iterator(this, elements, nullptr, Iterator::Reversed, 0, _size));
+    }
+
+    /**
+     * @return a view of the container in middle out order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::middleOut() {
+        markWritten();
+        return View(Iterator(this, elements, nullptr, Iterator::MiddleOut, 0, _size));
+    }
+
+    /**
+     * @tparam Comparator A callable that defines the sort order.
+     * @param comp The comparator function or functor.
+     * @return a view of the container sorted with comp
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Comparator>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::sortedWith(Comparator comp) {
+        return View(beginSortedWith(comp));
+    }
+
+    /**
+     * @tparam KeyFn A callable taking const T& and returning a key ordered by <.
+     * @param key The key extractor.
+     * @return a view of the container sorted by the key of each element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename KeyFn>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::sortedBy(KeyFn key) {
+        return View(beginSortedBy(key));
+    }
+
+    /**
+     * @return a view of the container in ascending order, sorted as far as it is read
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::lazyAscending() {
+        return View(beginLazyAscendingOrder());
+    }
+
+    /**
+     * Returns a view of the k first elements of the order of a comparator, by default the k largest
+     * in descending order. Only a heap of k elements is kept while scanning, so a leaderboard of a
+     * large container costs O(n log k) instead of a full sort. Equal elements keep their insertion order.
+     * @tparam Comparator A callable that defines the sort order, as for sortedWith.
+     * @param k the number of elements, the whole container when it has fewer
+     * @param comp The comparator function or functor.
+     * @return a view of min(k, size) elements
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    template<typename Comparator>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::topK(size_t k, Comparator comp) {
+        std::lock_guard<std::mutex> lock(viewMutex);
+        k = std::min(k, _size);
+        retireView(rankedView);
+        withSlots(wideIndices(), nullptr, [this, k, &comp](auto *type) {
+            using Slot = std::remove_pointer_t<decltype(type)>;
+            adoptView(rankedView, this->template createBestSlots<Slot>(k, comp));
+        });
+        rankedView.size = k;
+        rankedView.capacity = k;
+        return View(viewIterator(rankedView, 0));
+    }
+
+    /**
+     * @param k the number of elements, the whole container when it has fewer
+     * @return a view of the k smallest elements in ascending order
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::View MyContainer<T, InlineCapacity, GrowthPolicy>::bottomK(const size_t k) {
+        return topK(k, std::less<T>());
+    }
+
+    /**
+     * Sort the elements into spilled runs, the merge starts with begin().
+     * @param container the container to sort
+     * @param memory_budget the bytes the sort buffers may take
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::ExternalView(MyContainer *container, const size_t memory_budget)
+        : container(container), count(container->_size) {
+        sort = std::make_unique<ExternalSort<Record, RecordLess>>(memory_budget, RecordLess{container});
+        sort->build(count, [container](size_t i) -> Record {
+            if constexpr (holdsIndices) {
+                return i;
+            } else {
+                return container->elements[i];
+            }
+        });
+        ++container->activeIterators;
+    }
+
+    /**
+     * Move constructor for ExternalView, other no longer blocks the container
+     * @param other the view to move from
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::ExternalView(ExternalView &&other) noexcept
+        : container(other.container), sort(std::move(other.sort)), current(std::move(other.current)),
+          position(other.position), count(other.count) {
+        other.container = nullptr;
+    }
+
+    /**
+     * Destructor for ExternalView, closes (and so deletes) the temporary files
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::~ExternalView() {
+        if (container) {
+            --container->activeIterators;
+        }
+    }
+
+    /**
+     * Compare two records by the elements they stand for.
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::RecordLess::operator()(const Record &a, const Record &b) const {
+        if constexpr (holdsIndices) {
+            return container->elements[a] < container->elements[b];
+        } else {
+            return a < b;
+        }
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    void MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::advance() {
+        if (!sort->next([this](const Record &record) { current = record; })) {
+            current.reset();
+        }
+    }
+
+    /**
+     * @return a cursor at the current position of the traversal, which starts it on the first call
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::begin() {
+        if (position == 0 && !current && count > 0) {
+            advance();
+        }
+        return Cursor(this, position);
+    }
+
+    /**
+     * @return a cursor past the largest element
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::end() {
+        return Cursor(this, count);
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::size() const {
+        return count;
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::runCount() const {
+        return sort->runCount();
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    size_t MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::peakMemory() const {
+        return sort->peakMemory();
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::Cursor(ExternalView *view, const size_t position)
+        : view(view), position(position) {
+    }
+
+    /**
+     * @return the element at the cursor
+     * @throws OutOfRange at the end
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    const T &MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::operator*() const {
+        if (position != view->position || !view->current) {
+            throw OutOfRange("Cursor is not at the current position of the traversal");
+        }
+        if constexpr (holdsIndices) {
+            return view->container->elements[*view->current];
+        } else {
+            return *view->current;
+        }
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    const T *MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::operator->() const {
+        return &**this;
+    }
+
+    /**
+     * Move to the next element, the merge moves with it
+     * @throws OutOfRange at the end
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor &MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::operator++() {
+        if (position != view->position || position >= view->count) {
+            throw OutOfRange("Cursor is not at the current position of the traversal");
+        }
+        view->advance();
+        position = ++view->position;
+        return *this;
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::operator==(const Cursor &other) const {
+        return view == other.view && position == other.position;
+    }
+
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    bool MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView::Cursor::operator!=(const Cursor &other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * Returns the ascending order of the container sorted within a memory budget: at most memory_budget
+     * bytes of elements (or of indices, for views of indices) are held at once, the rest is spilled to
+     * temporary files and merged while it is read. Equal elements keep their insertion order.
+     * @param memory_budget the bytes the sort may hold, a few elements at least
+     * @return a single pass view of the ascending order
+     * @throws SpillFailed if the temporary files cannot be used
+     */
+    template<typename T, size_t InlineCapacity, typename GrowthPolicy>
+    typename MyContainer<T, InlineCapacity, GrowthPolicy>::ExternalView MyContainer<T, InlineCapacity, GrowthPolicy>::externalAscending(const size_t memory_budget) {
+        return ExternalView(this, memory_budget);
     }
 }
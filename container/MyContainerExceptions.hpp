@@ -21,3 +21,8 @@ class ActiveIterator : public std::runtime_error {
 public:
     explicit ActiveIterator(const std::string& msg) : std::runtime_error(msg) {}
 };
+
+class SpillFailed : public std::runtime_error {
+public:
+    explicit SpillFailed(const std::string& msg) : std::runtime_error(msg) {}
+};
@@ -0,0 +1,347 @@
+#pragma once
+#include "MyContainerExceptions.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MyContainerNamespace {
+    /**
+     * Stable sort of more records than may be held in memory at once. Chunks of half the memory budget
+     * are merge sorted with a scratch buffer of the other half and written to temporary files as runs.
+     * Runs are merged k at a time as soon as k of the same size are written, so the open files only grow
+     * with the logarithm of the record count, and once more at the end while there are more than k. The
+     * final merge is not written anywhere: next() streams it record by record.
+     * Records that fit in half the budget altogether are simply sorted in memory.
+     * Every buffer (chunk, sort scratch, one read buffer per run, the heap, the write buffer) is counted,
+     * no sort allocates behind the budget's back and the files are unbuffered, stdio holds nothing. They stay within it as long as it holds a few records
+     * (two at least); peakMemory() reports what they used.
+     * @tparam Record a trivially copyable, default constructible record, written to the files as raw bytes
+     * @tparam Less a strict weak order on records
+     */
+    template<typename Record, typename Less>
+    class ExternalSort {
+        static_assert(std::is_trivially_copyable_v<Record>, "records are spilled to files as raw bytes");
+        static_assert(std::is_default_constructible_v<Record>, "records are read back into buffers");
+
+    public:
+        /**
+         * @param memory_budget the bytes the buffers may take
+         * @param less the order to sort by
+         */
+        ExternalSort(size_t memory_budget, Less less) : budget(memory_budget), less(std::move(less)) {
+        }
+
+        /**
+         * Sort count records, the i-th one is source(i). Equal records keep the order of i.
+         * @param count the number of records
+         * @param source a callable returning the record of an index
+         * @throws SpillFailed if a temporary file cannot be created, written or read
+         */
+        template<typename Source>
+        void build(const size_t count, Source source) {
+            // Half the budget holds the records, the other half the scratch of the merge sort
+            const size_t chunk = std::max<size_t>(1, budget / (2 * sizeof(Record)));
+            if (count <= chunk) {
+                inMemory.reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    inMemory.push_back(source(i));
+                }
+                std::vector<Record> scratch(count);
+                note((inMemory.capacity() + scratch.size()) * sizeof(Record));
+                sortChunk(inMemory.data(), count, scratch.data());
+                return;
+            }
+            const size_t fan_in = std::max<size_t>(2, budget / (4 * sizeof(Record) + sizeof(size_t)));
+            // Runs by level, a run of level l holds fan_in^l chunks. A level that reaches fan_in runs is merged
+            // into one run of the next level right away, like a counter in base fan_in, so at most fan_in files
+            // per level are open instead of one per chunk. The runs of a level precede those of the levels below
+            std::vector<std::vector<Run>> levels(1);
+            std::vector<Record> buffer;
+            std::vector<Record> scratch;
+            for (size_t start = 0; start < count; start += chunk) {
+                if (buffer.capacity() == 0) {
+                    buffer.reserve(chunk);
+                    scratch.resize(chunk);
+                    note(2 * chunk * sizeof(Record));
+                }
+                buffer.clear();
+                for (size_t i = start; i < std::min(start + chunk, count); ++i) {
+                    buffer.push_back(source(i));
+                }
+                sortChunk(buffer.data(), buffer.size(), scratch.data());
+                levels[0].push_back(writeRun(buffer.data(), buffer.size()));
+                ++spilled;
+                if (levels[0].size() < fan_in) {
+                    continue;
+                }
+                // The merges get the whole budget, the chunk buffers are allocated again for the next chunk
+                std::vector<Record>().swap(buffer);
+                std::vector<Record>().swap(scratch);
+                for (size_t level = 0; level < levels.size() && levels[level].size() == fan_in; ++level) {
+                    Run merged = mergeRuns(levels[level], 0, fan_in);
+                    levels[level].clear();
+                    if (level + 1 == levels.size()) {
+                        levels.emplace_back();
+                    }
+                    levels[level + 1].push_back(std::move(merged));
+                }
+            }
+            std::vector<Record>().swap(buffer);
+            std::vector<Record>().swap(scratch);
+            std::vector<Run> runs;
+            for (size_t level = levels.size(); level-- > 0;) {
+                for (Run &run : levels[level]) {
+                    runs.push_back(std::move(run));
+                }
+            }
+            // Merge neighbouring groups while there are too many runs to read at once, which keeps ties in order
+            while (runs.size() > fan_in) {
+                std::vector<Run> merged;
+                for (size_t first = 0; first < runs.size(); first += fan_in) {
+                    const size_t last = std::min(first + fan_in, runs.size());
+                    if (last - first == 1) {
+                        merged.push_back(std::move(runs[first]));
+                        continue;
+                    }
+                    merged.push_back(mergeRuns(runs, first, last));
+                }
+                runs = std::move(merged);
+            }
+            startMerge(std::move(runs), 0);
+        }
+
+        /**
+         * Take the next record of the sorted order.
+         * @param take called with the record
+         * @return false once every record was taken
+         */
+        template<typename Take>
+        bool next(Take take) {
+            if (inputs.empty()) {
+                if (position == inMemory.size()) {
+                    return false;
+                }
+                take(inMemory[position++]);
+                return true;
+            }
+            return pull(inputs, heap, take);
+        }
+
+        /**
+         * @return the number of runs written to temporary files, 0 when everything fit in memory
+         */
+        size_t runCount() const {
+            return spilled;
+        }
+
+        /**
+         * @return the most bytes the buffers held at once
+         */
+        size_t peakMemory() const {
+            return peak;
+        }
+
+    private:
+        struct FileCloser {
+            void operator()(std::FILE *file) const {
+                std::fclose(file);
+            }
+        };
+
+        using File = std::unique_ptr<std::FILE, FileCloser>;
+
+        struct Run {
+            File file; // deleted by the system once closed
+            size_t size; // records in the file
+        };
+
+        // A run being merged, read through a buffer
+        struct Input {
+            Run run;
+            std::vector<Record> buffer;
+            size_t position = 0;
+            size_t filled = 0;
+            size_t read = 0; // records of the run read into the buffer so far
+        };
+
+        size_t budget;
+        Less less;
+        std::vector<Record> inMemory;
+        size_t position = 0;
+        std::vector<Input> inputs;
+        std::vector<size_t> heap; // the inputs with records left, the smallest front record on top
+        size_t spilled = 0;
+        size_t peak = 0;
+
+        void note(const size_t bytes) {
+            peak = std::max(peak, bytes);
+        }
+
+        /**
+         * Stable bottom-up merge sort. std::stable_sort would allocate its own buffer of up to half the
+         * records, outside the budget; this one only uses the scratch it is given.
+         * @param records the records to sort
+         * @param count how many there are
+         * @param scratch room for count records
+         */
+        void sortChunk(Record *records, const size_t count, Record *scratch) const {
+            constexpr size_t block = 16; // sorted by insertion first
+            for (size_t start = 0; start < count; start += block) {
+                const size_t end = std::min(start + block, count);
+                for (size_t i = start + 1; i < end; ++i) {
+                    const Record record = records[i];
+                    size_t j = i;
+                    for (; j > start && less(record, records[j - 1]); --j) {
+                        records[j] = records[j - 1];
+                    }
+                    records[j] = record;
+                }
+            }
+            // Merge neighbouring blocks back and forth between the two buffers, the left one wins ties
+            Record *from = records;
+            Record *to = scratch;
+            for (size_t width = block; width < count; width *= 2) {
+                for (size_t left = 0; left < count; left += 2 * width) {
+                    const size_t middle = std::min(left + width, count);
+                    const size_t right = std::min(left + 2 * width, count);
+                    std::merge(from + left, from + middle, from + middle, from + right, to + left, less);
+                }
+                std::swap(from, to);
+            }
+            if (from != records) {
+                std::copy(from, from + count, records);
+            }
+        }
+
+        /**
+         * A temporary file for a run, unbuffered: the records already go through the counted buffers in
+         * batches, and a stdio buffer per file (4 KiB or so each) would be memory outside the budget.
+         */
+        static File createFile() {
+            File file(std::tmpfile());
+            if (!file || std::setvbuf(file.get(), nullptr, _IONBF, 0) != 0) {
+                throw SpillFailed("Cannot create a temporary file for a sorted run");
+            }
+            return file;
+        }
+
+        static Run writeRun(const Record *records, const size_t count) {
+            File file = createFile();
+            if (std::fwrite(records, sizeof(Record), count, file.get()) != count) {
+                throw SpillFailed("Cannot write a sorted run to its temporary file");
+            }
+            return Run{std::move(file), count};
+        }
+
+        static void appendRun(Run &run, const Record *records, const size_t count) {
+            if (std::fwrite(records, sizeof(Record), count, run.file.get()) != count) {
+                throw SpillFailed("Cannot write a sorted run to its temporary file");
+            }
+            run.size += count;
+        }
+
+        // Refill the buffer of an input, false when its run is exhausted
+        static bool refill(Input &input) {
+            const size_t count = std::min(input.buffer.size(), input.run.size - input.read);
+            if (count == 0) {
+                return false;
+            }
+            if (std::fread(input.buffer.data(), sizeof(Record), count, input.run.file.get()) != count) {
+                throw SpillFailed("Cannot read a sorted run back from its temporary file");
+            }
+            input.read += count;
+            input.filled = count;
+            input.position = 0;
+            return true;
+        }
+
+        /**
+         * Open runs for a merge, sharing the budget between their buffers and extra buffers of records
+         * the caller keeps (the write buffer of an intermediate pass).
+         */
+        void openInputs(std::vector<Run> runs, std::vector<Input> &opened, std::vector<size_t> &order, const size_t extra) {
+            const size_t share = budget / (runs.size() + extra);
+            const size_t records = std::max<size_t>(1, (share > sizeof(size_t) ? share - sizeof(size_t) : 0) / sizeof(Record));
+            opened.clear();
+            order.clear();
+            opened.reserve(runs.size());
+            order.reserve(runs.size());
+            for (Run &run : runs) {
+                std::rewind(run.file.get());
+                Input input;
+                input.run = std::move(run);
+                input.buffer.resize(records);
+                opened.push_back(std::move(input));
+            }
+            note(opened.size() * (records * sizeof(Record) + sizeof(size_t)) + extra * records * sizeof(Record));
+            for (size_t i = 0; i < opened.size(); ++i) {
+                if (refill(opened[i])) {
+                    order.push_back(i);
+                    std::push_heap(order.begin(), order.end(), after(opened));
+                }
+            }
+        }
+
+        // The heap order: an input comes after another if its front record is larger, or equal from a later run
+        auto after(const std::vector<Input> &opened) const {
+            return [this, &opened](size_t a, size_t b) {
+                const Record &x = opened[a].buffer[opened[a].position];
+                const Record &y = opened[b].buffer[opened[b].position];
+                if (less(y, x)) return true;
+                return !less(x, y) && a > b;
+            };
+        }
+
+        // Take the smallest front record out of the merge
+        template<typename Take>
+        bool pull(std::vector<Input> &opened, std::vector<size_t> &order, Take take) {
+            if (order.empty()) {
+                return false;
+            }
+            std::pop_heap(order.begin(), order.end(), after(opened));
+            Input &input = opened[order.back()];
+            take(input.buffer[input.position++]);
+            if (input.position < input.filled || refill(input)) {
+                std::push_heap(order.begin(), order.end(), after(opened));
+            } else {
+                input.run.file.reset();
+                order.pop_back();
+            }
+            return true;
+        }
+
+        void startMerge(std::vector<Run> runs, const size_t extra) {
+            openInputs(std::move(runs), inputs, heap, extra);
+        }
+
+        // Merge runs[first, last) into a new run
+        Run mergeRuns(std::vector<Run> &runs, const size_t first, const size_t last) {
+            std::vector<Run> group;
+            for (size_t r = first; r < last; ++r) {
+                group.push_back(std::move(runs[r]));
+            }
+            std::vector<Input> opened;
+            std::vector<size_t> order;
+            openInputs(std::move(group), opened, order, 1);
+            const size_t capacity = opened.front().buffer.size();
+            std::vector<Record> output;
+            output.reserve(capacity);
+            Run merged{createFile(), 0};
+            const auto write = [&merged, &output, capacity](const Record &record) {
+                output.push_back(record);
+                if (output.size() == capacity) {
+                    appendRun(merged, output.data(), output.size());
+                    output.clear();
+                }
+            };
+            while (pull(opened, order, write)) {
+            }
+            appendRun(merged, output.data(), output.size());
+            return merged;
+        }
+    };
+}
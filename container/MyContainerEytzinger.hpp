@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace MyContainerNamespace {
+    /**
+     * A sorted array in Eytzinger (breadth-first) order: the root at 1, the children of k at 2k and 2k + 1.
+     * A binary search then reads its keys front to back, the first levels share a few cache lines,
+     * and the 16 descendants four levels below k are contiguous, so they are prefetched while the four
+     * comparisons in between run. The comparison picks the child arithmetically instead of branching,
+     * there is nothing to mispredict. The rank of a key, its position in the sorted array, follows from its
+     * index, so only the keys are stored.
+     * @tparam Key a copyable key ordered by <
+     */
+    template<typename Key>
+    class EytzingerLayout {
+    public:
+        /**
+         * @param resource where the keys are allocated
+         */
+        explicit EytzingerLayout(std::pmr::memory_resource *resource) : keys(resource) {
+        }
+
+        /**
+         * Lay out a sorted array.
+         * @param sorted the keys in ascending order
+         * @param count the number of keys
+         */
+        void build(const Key *sorted, const size_t count) {
+            release();
+            if (count == 0) {
+                return;
+            }
+            keys.assign(count + 1, sorted[0]);
+            size_t next = 0;
+            place(sorted, next, 1);
+        }
+
+        /**
+         * @param value the value to search for
+         * @return the rank of the first key not less than value, size() if there is none
+         */
+        size_t lowerBound(const Key &value) const {
+            return rank(search<false>(value));
+        }
+
+        /**
+         * @param value the value to search for
+         * @return the rank of the first key greater than value, size() if there is none
+         */
+        size_t upperBound(const Key &value) const {
+            return rank(search<true>(value));
+        }
+
+        /**
+         * @param value the value to search for
+         * @return true if a key is equivalent to value
+         */
+        bool contains(const Key &value) const {
+            const size_t k = search<false>(value);
+            return k != 0 && !(value < keys[k]);
+        }
+
+        /**
+         * @return the number of keys
+         */
+        size_t size() const {
+            return keys.empty() ? 0 : keys.size() - 1;
+        }
+
+        // Forget the keys and free the memory
+        void release() {
+            std::pmr::vector<Key>(keys.get_allocator()).swap(keys);
+        }
+
+    private:
+        static constexpr size_t prefetchStride = std::max<size_t>(1, 64 / sizeof(Key)); // keys per cache line
+
+        std::pmr::vector<Key> keys; // keys[0] is unused
+
+        // In-order walk of the implicit tree, handing out the sorted keys
+        void place(const Key *sorted, size_t &next, const size_t k) {
+            if (k >= keys.size()) {
+                return;
+            }
+            place(sorted, next, 2 * k);
+            keys[k] = sorted[next++];
+            place(sorted, next, 2 * k + 1);
+        }
+
+        /**
+         * Walk down to a leaf going right past every key before value, then climb back to the last
+         * node where the walk went left: the first key not before value.
+         * @tparam Upper keys equal to value count as before it
+         * @return the index of that key, 0 if there is none
+         */
+        template<bool Upper>
+        size_t search(const Key &value) const {
+            const size_t n = size();
+            const Key *const data = keys.data();
+            size_t k = 1;
+            while (k <= n) {
+                __builtin_prefetch(data + std::min(k * prefetchStride, n));
+                if constexpr (Upper) {
+                    k = 2 * k + static_cast<size_t>(!(value < data[k]));
+                } else {
+                    k = 2 * k + static_cast<size_t>(data[k] < value);
+                }
+            }
+            // Drop the trailing right turns and the last left turn
+            k >>= __builtin_ffsll(static_cast<long long>(~k));
+            return k;
+        }
+
+        /**
+         * The tree is complete: in the perfect tree of the same height, the j-th node of depth d comes
+         * (2j + 1) * 2^(height - d) - 1 nodes into the in-order walk, and the leaves of the last level
+         * sit at the even places. Subtract the missing leaves before it.
+         */
+        size_t rank(const size_t k) const {
+            const size_t n = size();
+            if (k == 0) {
+                return n;
+            }
+            const unsigned height = 63u - static_cast<unsigned>(__builtin_clzll(n));
+            const unsigned depth = 63u - static_cast<unsigned>(__builtin_clzll(k));
+            const size_t perfect = ((2 * (k - (size_t{1} << depth)) + 1) << (height - depth)) - 1;
+            const size_t leaves = n - (size_t{1} << height) + 1;
+            const size_t before = (perfect + 1) / 2; // leaf places before it
+            return perfect - (before > leaves ? before - leaves : 0);
+        }
+    };
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+
+namespace MyContainerNamespace {
+    /**
+     * Capacity policy for MyContainer.
+     * A full container grows to GrowNumerator / GrowDenominator times its capacity.
+     * After a removal leaves fewer than capacity / ShrinkDivisor elements the capacity is halved,
+     * so the container must refill half of the freed space before it grows again (hysteresis).
+     * ShrinkDivisor 0 never gives memory back.
+     */
+    template<size_t GrowNumerator, size_t GrowDenominator, size_t ShrinkDivisor>
+    struct GeometricGrowth {
+        static_assert(GrowDenominator > 0 && GrowNumerator > GrowDenominator, "growth factor must be above 1");
+        static_assert(ShrinkDivisor == 0 || ShrinkDivisor > 2, "shrinking must leave free space behind");
+
+        /**
+         * @param capacity the current capacity
+         * @param required the number of elements that must fit
+         * @return the capacity to grow to, at least required
+         */
+        static size_t grow(size_t capacity, size_t required) {
+            size_t next = capacity / GrowDenominator * GrowNumerator
+                          + capacity % GrowDenominator * GrowNumerator / GrowDenominator;
+            if (next <= capacity) {
+                next = capacity + 1; // small capacities would not grow at all otherwise
+            }
+            return next < required ? required : next;
+        }
+
+        /**
+         * @param size the number of elements left after a removal
+         * @param capacity the current capacity
+         * @return the capacity to shrink to, capacity itself to keep it and 0 to free the buffer
+         */
+        static size_t shrink(size_t size, size_t capacity) {
+            if (ShrinkDivisor == 0) {
+                return capacity;
+            }
+            if (size == 0) {
+                return 0;
+            }
+            if (size < capacity / ShrinkDivisor && capacity > 1) {
+                return capacity / 2;
+            }
+            return capacity;
+        }
+    };
+
+    // Doubles when full, halves below a quarter full. The default policy
+    using DoublingGrowth = GeometricGrowth<2, 1, 4>;
+
+    // Grows by 1.5x, less memory overhead for a few more reallocations
+    using OneAndHalfGrowth = GeometricGrowth<3, 2, 4>;
+
+    // Doubles when full and keeps its memory, for containers that refill to the same size
+    using NeverShrinkGrowth = GeometricGrowth<2, 1, 0>;
+}
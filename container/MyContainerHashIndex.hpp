@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MyContainerNamespace {
+    // Whether T has an enabled std::hash, == and a copy constructor, what a hash index of T needs
+    template<typename T, typename = void>
+    struct Hashable : std::false_type {
+    };
+
+    template<typename T>
+    struct Hashable<T, std::void_t<decltype(std::hash<T>()(std::declval<const T &>())),
+                                   decltype(std::declval<const T &>() == std::declval<const T &>())>>
+        : std::is_copy_constructible<T> {
+    };
+
+    /**
+     * Open-addressing hash table counting the occurrences of each distinct value of an array, with a
+     * lower bound on where the first one is. Linear probing over a power-of-two table kept at most half
+     * full; the buckets come from the top bits of hash * 2^64 / phi, which spreads even the identity
+     * hashes of integers. Erasing shifts the following entries back, so there are no tombstones.
+     * Removing elements from the array moves the rest down, which would change the position of almost
+     * every value; instead of renumbering the table, the positions are stored shifted by the number of
+     * elements removed so far, and read back as a lower bound that is exact until something before
+     * them is removed.
+     * @tparam T the value type, hashed with std::hash<T> and compared with ==
+     */
+    template<typename T>
+    class HashIndex {
+    public:
+        struct Entry {
+            size_t hash = 0;
+            size_t count = 0; // how many elements hold the value, 0 for a free entry
+            size_t mark = 0; // the first position plus the elements removed before it was stored
+            alignas(T) unsigned char bytes[sizeof(T)]; // a copy of the value while count > 0
+
+            T &value() { return *std::launder(reinterpret_cast<T *>(bytes)); }
+
+            const T &value() const { return *std::launder(reinterpret_cast<const T *>(bytes)); }
+        };
+
+        /**
+         * @param resource where the table is allocated
+         */
+        explicit HashIndex(std::pmr::memory_resource *resource) : entries(resource) {
+        }
+
+        HashIndex(const HashIndex &) = delete;
+
+        HashIndex &operator=(const HashIndex &) = delete;
+
+        ~HashIndex() {
+            clear();
+        }
+
+        /**
+         * @param value the value to look up
+         * @return its entry, nullptr if no element holds it
+         */
+        const Entry *find(const T &value) const {
+            if (used == 0) {
+                return nullptr;
+            }
+            const size_t hash = std::hash<T>()(value);
+            for (size_t i = bucket(hash);; i = (i + 1) & mask()) {
+                const Entry &entry = entries[i];
+                if (entry.count == 0) {
+                    return nullptr;
+                }
+                if (entry.hash == hash && entry.value() == value) {
+                    return &entry;
+                }
+            }
+        }
+
+        /**
+         * @param entry an entry from find()
+         * @return a position at or before the first element holding its value
+         */
+        size_t firstPosition(const Entry &entry) const {
+            return entry.mark > removedSoFar ? entry.mark - removedSoFar : 0;
+        }
+
+        /**
+         * Count one more element. A position before the first one known of becomes the new bound.
+         * @param value its value
+         * @param position its position
+         */
+        void add(const T &value, const size_t position) {
+            reserve(used + 1);
+            const size_t hash = std::hash<T>()(value);
+            for (size_t i = bucket(hash);; i = (i + 1) & mask()) {
+                Entry &entry = entries[i];
+                if (entry.count == 0) {
+                    ::new(static_cast<void *>(entry.bytes)) T(value);
+                    entry.hash = hash;
+                    entry.count = 1;
+                    entry.mark = position + removedSoFar;
+                    ++used;
+                    return;
+                }
+                if (entry.hash == hash && entry.value() == value) {
+                    ++entry.count;
+                    entry.mark = std::min(entry.mark, position + removedSoFar);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Forget a value after its elements were removed.
+         * @param found the entry of the value, from find()
+         * @param removed the number of elements removed with it, they move the others down
+         */
+        void erase(const Entry *found, const size_t removed) {
+            removedSoFar += removed;
+            unlink(static_cast<size_t>(found - entries.data()));
+        }
+
+        /**
+         * Count one element less after it was overwritten in place, no position moves. The first
+         * position stays a lower bound even if it was that element.
+         * @param found the entry of its old value, from find()
+         */
+        void discount(const Entry *found) {
+            const size_t at = static_cast<size_t>(found - entries.data());
+            if (entries[at].count > 1) {
+                --entries[at].count;
+                return;
+            }
+            unlink(at);
+        }
+
+        /**
+         * Make room for count distinct values without growing again.
+         * @param count the number of values
+         */
+        void reserve(const size_t count) {
+            if (2 * count <= entries.size()) {
+                return;
+            }
+            size_t capacity = std::max<size_t>(16, entries.size());
+            while (capacity < 2 * count) {
+                capacity *= 2;
+            }
+            unsigned new_shift = 64;
+            for (size_t bits = capacity; bits > 1; bits /= 2) {
+                --new_shift;
+            }
+            std::pmr::vector<Entry> grown(capacity, entries.get_allocator());
+            const auto place = [&grown, new_shift, capacity](const Entry &entry) -> Entry & {
+                size_t i = bucketIn(entry.hash, new_shift);
+                while (grown[i].count != 0) {
+                    i = (i + 1) & (capacity - 1);
+                }
+                return grown[i];
+            };
+            try {
+                for (Entry &entry : entries) {
+                    if (entry.count != 0) {
+                        Entry &target = place(entry);
+                        ::new(static_cast<void *>(target.bytes)) T(std::move_if_noexcept(entry.value()));
+                        target.hash = entry.hash;
+                        target.count = entry.count;
+                        target.mark = entry.mark;
+                    }
+                }
+            } catch (...) {
+                for (Entry &entry : grown) {
+                    if (entry.count != 0) {
+                        destroy(entry);
+                    }
+                }
+                throw;
+            }
+            destroyAll();
+            entries.swap(grown);
+            shift = new_shift;
+        }
+
+        // Forget every value, the table keeps its memory
+        void clear() {
+            destroyAll();
+            used = 0;
+            removedSoFar = 0;
+        }
+
+        // Forget every value and free the table
+        void release() {
+            clear();
+            std::pmr::vector<Entry>(entries.get_allocator()).swap(entries);
+            shift = 64;
+        }
+
+        /**
+         * @return the number of distinct values
+         */
+        size_t size() const {
+            return used;
+        }
+
+        /**
+         * @return the number of elements removed since the index was cleared, each one loosened the
+         * bounds of the values after it
+         */
+        size_t removed() const {
+            return removedSoFar;
+        }
+
+    private:
+        std::pmr::vector<Entry> entries;
+        size_t used = 0;
+        size_t removedSoFar = 0;
+        unsigned shift = 64; // 64 - log2 of the table size
+
+        size_t mask() const {
+            return entries.size() - 1;
+        }
+
+        static size_t bucketIn(const size_t hash, const unsigned shift) {
+            return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        size_t bucket(const size_t hash) const {
+            return bucketIn(hash, shift);
+        }
+
+        void destroyAll() {
+            for (Entry &entry : entries) {
+                if (entry.count != 0) {
+                    destroy(entry);
+                }
+            }
+        }
+
+        // Free the entry at hole, moving back the entries that probed past it
+        void unlink(size_t hole) {
+            destroy(entries[hole]);
+            --used;
+            for (size_t i = (hole + 1) & mask();; i = (i + 1) & mask()) {
+                Entry &next = entries[i];
+                if (next.count == 0) {
+                    return;
+                }
+                // An entry may fill the hole if the hole lies between its bucket and where it is
+                if (((i - bucket(next.hash)) & mask()) >= ((i - hole) & mask())) {
+                    Entry &target = entries[hole];
+                    ::new(static_cast<void *>(target.bytes)) T(std::move_if_noexcept(next.value()));
+                    target.hash = next.hash;
+                    target.count = next.count;
+                    target.mark = next.mark;
+                    destroy(next);
+                    hole = i;
+                }
+            }
+        }
+
+        static void destroy(Entry &entry) {
+            std::destroy_at(&entry.value());
+            entry.count = 0;
+        }
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+
+namespace MyContainerNamespace {
+    /**
+     * Memory resource on top of malloc/realloc/free.
+     * MyContainer recognises it and grows buffers of trivially copyable elements with reallocate(),
+     * which can extend a block in place instead of copying it. For large blocks glibc serves realloc
+     * with mremap, so even a move to a new address only remaps pages.
+     */
+    class ReallocResource : public std::pmr::memory_resource {
+    public:
+        /**
+         * Resize a block from this resource, keeping its first min(old_bytes, new_bytes) bytes.
+         * @param p the block to resize
+         * @param old_bytes the size it was allocated with
+         * @param new_bytes the size it must have
+         * @param alignment the alignment it was allocated with
+         * @return the resized block, p itself when it could grow in place
+         */
+        void *reallocate(void *p, size_t old_bytes, size_t new_bytes, size_t alignment) {
+            if (alignment > alignof(std::max_align_t)) {
+                // realloc does not keep extended alignments, copy by hand
+                void *fresh = do_allocate(new_bytes, alignment);
+                std::memcpy(fresh, p, old_bytes < new_bytes ? old_bytes : new_bytes);
+                do_deallocate(p, old_bytes, alignment);
+                return fresh;
+            }
+            void *resized = std::realloc(p, new_bytes == 0 ? 1 : new_bytes);
+            if (resized == nullptr) {
+                throw std::bad_alloc();
+            }
+            return resized;
+        }
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            void *p;
+            if (alignment > alignof(std::max_align_t)) {
+                // aligned_alloc wants a size that is a multiple of the alignment
+                p = std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+            } else {
+                p = std::malloc(bytes == 0 ? 1 : bytes);
+            }
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+
+        void do_deallocate(void *p, size_t, size_t) override {
+            std::free(p);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return dynamic_cast<const ReallocResource *>(&other) != nullptr;
+        }
+    };
+
+    /**
+     * @return the process-wide ReallocResource
+     */
+    inline ReallocResource *reallocResource() {
+        static ReallocResource resource;
+        return &resource;
+    }
+}
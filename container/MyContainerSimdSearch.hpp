@@ -0,0 +1,263 @@
+#pragma once
+#include "MyContainerSimdSort.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace MyContainerNamespace {
+    // Element types with search kernels: integers, characters, bool and IEEE-754 floats of 1 to 8 bytes
+    template<typename T>
+    struct SimdSearchable : std::bool_constant<std::is_arithmetic_v<T> &&
+                                               (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) &&
+                                               (!std::is_floating_point_v<T> || std::is_same_v<T, float> || std::is_same_v<T, double>)> {
+    };
+
+    /**
+     * Linear search of arrays of SimdSearchable elements a vector at a time: the vector is compared with
+     * the value broadcast to every lane, and the comparison is turned into a bit mask with one bit per
+     * byte (movemask), so a match is found with a count of trailing zeros and counted with a popcount.
+     * find() tests four vectors per step and only looks inside them once one matched.
+     * Floats are compared as floats, so 0.0 finds -0.0 and NaN finds nothing, exactly like ==.
+     * The kernels are chosen like SimdSort's: AVX2 when the CPU has it, SSE2 otherwise, plain loops
+     * elsewhere.
+     */
+    class SimdSearch {
+    public:
+        using Level = SimdSort::Level;
+
+        /**
+         * @param first the first element
+         * @param last one past the last element
+         * @param value the value to look for
+         * @param level the kernels to use, at most SimdSort::best()
+         * @return the position of the first element equal to value, last - first if there is none
+         */
+        template<typename T>
+        static size_t find(const T *first, const T *last, const T value, const Level level = SimdSort::best()) {
+            static_assert(SimdSearchable<T>::value, "no search kernels for this element type");
+            const size_t size = static_cast<size_t>(last - first);
+#ifdef MY_CONTAINER_X86_SIMD
+            if (level == SimdSort::Avx2) {
+                return findAvx2(first, size, value);
+            }
+            if (level == SimdSort::Sse2) {
+                return findSse2(first, size, value);
+            }
+#else
+            (void) level;
+#endif
+            return scalarFind(first, 0, size, value);
+        }
+
+        /**
+         * @param first the first element
+         * @param last one past the last element
+         * @param value the value to count
+         * @param level the kernels to use, at most SimdSort::best()
+         * @return the number of elements equal to value
+         */
+        template<typename T>
+        static size_t count(const T *first, const T *last, const T value, const Level level = SimdSort::best()) {
+            static_assert(SimdSearchable<T>::value, "no search kernels for this element type");
+            const size_t size = static_cast<size_t>(last - first);
+#ifdef MY_CONTAINER_X86_SIMD
+            if (level == SimdSort::Avx2) {
+                return countAvx2(first, size, value);
+            }
+            if (level == SimdSort::Sse2) {
+                return countSse2(first, size, value);
+            }
+#else
+            (void) level;
+#endif
+            return scalarCount(first, 0, size, value);
+        }
+
+    private:
+        template<typename T>
+        static size_t scalarFind(const T *data, size_t from, const size_t size, const T value) {
+            for (; from < size; ++from) {
+                if (data[from] == value) {
+                    return from;
+                }
+            }
+            return size;
+        }
+
+        template<typename T>
+        static size_t scalarCount(const T *data, size_t from, const size_t size, const T value) {
+            size_t found = 0;
+            for (; from < size; ++from) {
+                found += data[from] == value;
+            }
+            return found;
+        }
+
+        /**
+         * Find with Ops::lanes elements per vector. Inlined into the kernels of each instruction set,
+         * which are compiled for it.
+         */
+        template<typename Ops, typename T>
+        static size_t findWith(const T *data, const size_t size, const T value) {
+            constexpr size_t lanes = Ops::lanes;
+            const Ops ops(value);
+            size_t i = 0;
+            for (; i + 4 * lanes <= size; i += 4 * lanes) {
+                const uint64_t m0 = ops.matches(data + i);
+                const uint64_t m1 = ops.matches(data + i + lanes);
+                const uint64_t m2 = ops.matches(data + i + 2 * lanes);
+                const uint64_t m3 = ops.matches(data + i + 3 * lanes);
+                if ((m0 | m1 | m2 | m3) != 0) {
+                    const uint64_t low = m0 | m1 << (lanes * sizeof(T));
+                    if (low != 0) {
+                        return i + static_cast<size_t>(__builtin_ctzll(low)) / sizeof(T);
+                    }
+                    const uint64_t high = m2 | m3 << (lanes * sizeof(T));
+                    return i + 2 * lanes + static_cast<size_t>(__builtin_ctzll(high)) / sizeof(T);
+                }
+            }
+            for (; i + lanes <= size; i += lanes) {
+                const uint64_t mask = ops.matches(data + i);
+                if (mask != 0) {
+                    return i + static_cast<size_t>(__builtin_ctzll(mask)) / sizeof(T);
+                }
+            }
+            return scalarFind(data, i, size, value);
+        }
+
+        // Count with Ops::lanes elements per vector, every match sets sizeof(T) bits of a mask
+        template<typename Ops, typename T>
+        static size_t countWith(const T *data, const size_t size, const T value) {
+            constexpr size_t lanes = Ops::lanes;
+            const Ops ops(value);
+            size_t bits = 0;
+            size_t i = 0;
+            for (; i + 2 * lanes <= size; i += 2 * lanes) {
+                bits += static_cast<size_t>(__builtin_popcountll(ops.matches(data + i) | ops.matches(data + i + lanes) << (lanes * sizeof(T))));
+            }
+            for (; i + lanes <= size; i += lanes) {
+                bits += static_cast<size_t>(__builtin_popcountll(ops.matches(data + i)));
+            }
+            return bits / sizeof(T) + scalarCount(data, i, size, value);
+        }
+
+#ifdef MY_CONTAINER_X86_SIMD
+        template<typename T>
+        struct Sse2Ops;
+
+        template<typename T>
+        struct Avx2Ops;
+
+        template<typename T>
+        static size_t findSse2(const T *data, size_t size, T value) {
+            return findWith<Sse2Ops<T>>(data, size, value);
+        }
+
+        template<typename T>
+        __attribute__((target("avx2"), flatten)) static size_t findAvx2(const T *data, size_t size, T value) {
+            return findWith<Avx2Ops<T>>(data, size, value);
+        }
+
+        template<typename T>
+        static size_t countSse2(const T *data, size_t size, T value) {
+            return countWith<Sse2Ops<T>>(data, size, value);
+        }
+
+        template<typename T>
+        __attribute__((target("avx2,popcnt"), flatten)) static size_t countAvx2(const T *data, size_t size, T value) {
+            return countWith<Avx2Ops<T>>(data, size, value);
+        }
+#endif
+    };
+
+#ifdef MY_CONTAINER_X86_SIMD
+    template<typename T>
+    struct SimdSearch::Sse2Ops {
+        static constexpr size_t lanes = 16 / sizeof(T);
+
+        __m128i needle; // the value in every lane
+
+        explicit Sse2Ops(const T value) {
+            if constexpr (std::is_same_v<T, float>) {
+                needle = _mm_castps_si128(_mm_set1_ps(value));
+            } else if constexpr (std::is_same_v<T, double>) {
+                needle = _mm_castpd_si128(_mm_set1_pd(value));
+            } else if constexpr (sizeof(T) == 1) {
+                needle = _mm_set1_epi8(static_cast<char>(value));
+            } else if constexpr (sizeof(T) == 2) {
+                needle = _mm_set1_epi16(static_cast<short>(value));
+            } else if constexpr (sizeof(T) == 4) {
+                needle = _mm_set1_epi32(static_cast<int>(value));
+            } else {
+                needle = _mm_set1_epi64x(static_cast<long long>(value));
+            }
+        }
+
+        // One bit per byte of the lanes equal to the needle
+        uint64_t matches(const T *at) const {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(at));
+            __m128i equal;
+            if constexpr (std::is_same_v<T, float>) {
+                equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(v), _mm_castsi128_ps(needle)));
+            } else if constexpr (std::is_same_v<T, double>) {
+                equal = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(v), _mm_castsi128_pd(needle)));
+            } else if constexpr (sizeof(T) == 1) {
+                equal = _mm_cmpeq_epi8(v, needle);
+            } else if constexpr (sizeof(T) == 2) {
+                equal = _mm_cmpeq_epi16(v, needle);
+            } else if constexpr (sizeof(T) == 4) {
+                equal = _mm_cmpeq_epi32(v, needle);
+            } else {
+                // No 64-bit compare before SSE4.1: both 32-bit halves must match
+                const __m128i halves = _mm_cmpeq_epi32(v, needle);
+                equal = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+            return static_cast<uint32_t>(_mm_movemask_epi8(equal));
+        }
+    };
+
+    template<typename T>
+    struct SimdSearch::Avx2Ops {
+        static constexpr size_t lanes = 32 / sizeof(T);
+
+        __m256i needle; // the value in every lane
+
+        __attribute__((target("avx2"))) explicit Avx2Ops(const T value) {
+            if constexpr (std::is_same_v<T, float>) {
+                needle = _mm256_castps_si256(_mm256_set1_ps(value));
+            } else if constexpr (std::is_same_v<T, double>) {
+                needle = _mm256_castpd_si256(_mm256_set1_pd(value));
+            } else if constexpr (sizeof(T) == 1) {
+                needle = _mm256_set1_epi8(static_cast<char>(value));
+            } else if constexpr (sizeof(T) == 2) {
+                needle = _mm256_set1_epi16(static_cast<short>(value));
+            } else if constexpr (sizeof(T) == 4) {
+                needle = _mm256_set1_epi32(static_cast<int>(value));
+            } else {
+                needle = _mm256_set1_epi64x(static_cast<long long>(value));
+            }
+        }
+
+        // One bit per byte of the lanes equal to the needle
+        __attribute__((target("avx2"))) uint64_t matches(const T *at) const {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(at));
+            __m256i equal;
+            if constexpr (std::is_same_v<T, float>) {
+                equal = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(v), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+            } else if constexpr (std::is_same_v<T, double>) {
+                equal = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(v), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+            } else if constexpr (sizeof(T) == 1) {
+                equal = _mm256_cmpeq_epi8(v, needle);
+            } else if constexpr (sizeof(T) == 2) {
+                equal = _mm256_cmpeq_epi16(v, needle);
+            } else if constexpr (sizeof(T) == 4) {
+                equal = _mm256_cmpeq_epi32(v, needle);
+            } else {
+                equal = _mm256_cmpeq_epi64(v, needle);
+            }
+            return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+        }
+    };
+#endif
+}
@@ -0,0 +1,423 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MY_CONTAINER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace MyContainerNamespace {
+    // Element types with vector kernels: 32 and 64-bit integers and IEEE-754 floats
+    template<typename T>
+    struct SimdSortable : std::bool_constant<std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+                                             std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t> ||
+                                             std::is_same_v<T, float> || std::is_same_v<T, double>> {
+    };
+
+    /**
+     * Branch-free sort of small arrays of SimdSortable elements with a bitonic sorting network.
+     * The elements are padded to a power of two of at least one vector, then every compare-exchange between elements at least
+     * one vector apart is a vector min/max. The steps inside a vector permute it against itself with AVX2
+     * and are scalar (and branch-free) with SSE2.
+     * The AVX2 kernels are chosen at run time when the CPU has them, SSE2 (every x86-64 CPU) otherwise,
+     * and std::sort elsewhere. Floats holding a zero or a NaN are left to std::stable_sort, since min/max
+     * would not keep -0.0 and 0.0 in their order.
+     */
+    class SimdSort {
+    public:
+        enum Level { Scalar, Sse2, Avx2 };
+
+        static constexpr size_t capacity = 256; // the largest array sorted by the kernels
+
+        /**
+         * @return the best level this CPU supports
+         */
+        static Level best() {
+#ifdef MY_CONTAINER_X86_SIMD
+            static const Level level = __builtin_cpu_supports("avx2") ? Avx2 : Sse2;
+            return level;
+#else
+            return Scalar;
+#endif
+        }
+
+        /**
+         * @param level a level
+         * @return true if this CPU can run it
+         */
+        static bool supports(Level level) {
+            return level <= best();
+        }
+
+        /**
+         * Sort [first, last) ascending, like std::stable_sort with <.
+         * @param first the first element
+         * @param last one past the last element, at most capacity elements
+         * @param level the kernels to use, at most best()
+         */
+        template<typename T>
+        static void sort(T *first, T *last, Level level = best()) {
+            static_assert(SimdSortable<T>::value, "no vector kernels for this element type");
+            const size_t size = static_cast<size_t>(last - first);
+            if (!kernelOrder(first, last)) {
+                std::stable_sort(first, last);
+                return;
+            }
+            // Apart from floating-point zeros, equal elements are identical and any sort is stable
+            if (level == Scalar || size < 2 || size > capacity || (level == Sse2 && sizeof(T) == 8 && std::is_integral_v<T>)) {
+                std::sort(first, last);
+                return;
+            }
+            // At least one whole vector: the kernels load and store full vectors, so every lane they
+            // touch must hold an element or the padding
+            size_t padded = (level == Avx2 ? 32 : 16) / sizeof(T);
+            while (padded < size) {
+                padded *= 2;
+            }
+            alignas(32) T data[capacity];
+            std::copy(first, last, data);
+            std::fill(data + size, data + padded, padding<T>());
+#ifdef MY_CONTAINER_X86_SIMD
+            if (level == Avx2) {
+                sortAvx2(data, padded);
+            } else {
+                sortSse2(data, padded);
+            }
+#endif
+            std::copy(data, data + size, first);
+        }
+
+    private:
+        // Above every element, so the padding sorts to the end
+        template<typename T>
+        static T padding() {
+            if constexpr (std::is_floating_point_v<T>) {
+                return std::numeric_limits<T>::infinity();
+            } else {
+                return std::numeric_limits<T>::max();
+            }
+        }
+
+        // false if min/max could order the elements differently from a stable sort with <
+        template<typename T>
+        static bool kernelOrder(const T *first, const T *last) {
+            if constexpr (std::is_floating_point_v<T>) {
+                return std::none_of(first, last, [](T value) { return value == 0 || std::isnan(value); });
+            } else {
+                (void) first;
+                (void) last;
+                return true;
+            }
+        }
+
+        /**
+         * The bitonic network over size (a power of two) elements, Ops::lanes at a time.
+         * Inlined into the kernels of each instruction set, which are compiled for it.
+         */
+        template<typename Ops, typename T>
+        static void bitonic(T *data, const size_t size) {
+            constexpr size_t lanes = Ops::lanes;
+            for (size_t k = 2; k <= size; k *= 2) {
+                for (size_t j = k / 2; j > 0; j /= 2) {
+                    if (j >= lanes) {
+                        // Both vectors lie in one half of a block of k, so they share the direction
+                        for (size_t block = 0; block < size; block += 2 * j) {
+                            for (size_t i = block; i < block + j; i += lanes) {
+                                if ((i & k) == 0) {
+                                    Ops::minMax(data + i, data + i + j);
+                                } else {
+                                    Ops::minMax(data + i + j, data + i);
+                                }
+                            }
+                        }
+                    } else if constexpr (Ops::inRegister) {
+                        for (size_t i = 0; i < size; i += lanes) {
+                            Ops::exchange(data + i, i, j, k);
+                        }
+                    } else {
+                        for (size_t i = 0; i < size; ++i) {
+                            const size_t other = i ^ j;
+                            if (other > i) {
+                                const T a = data[i];
+                                const T b = data[other];
+                                const bool up = (i & k) == 0;
+                                const T low = b < a ? b : a;
+                                const T high = b < a ? a : b;
+                                data[i] = up ? low : high;
+                                data[other] = up ? high : low;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+#ifdef MY_CONTAINER_X86_SIMD
+        // minMax(low, high) leaves the lane-wise minimum in low and the maximum in high.
+        // With inRegister, exchange(vector, base, j, k) does the network step j of block size k for
+        // the lanes of the vector at index base, whose partners are in the same vector.
+        template<typename T>
+        struct Sse2Ops;
+
+        template<typename T>
+        struct Avx2Ops;
+
+        template<typename T>
+        static void sortSse2(T *data, size_t size) {
+            bitonic<Sse2Ops<T>>(data, size);
+        }
+
+        template<typename T>
+        __attribute__((target("avx2"), flatten)) static void sortAvx2(T *data, size_t size) {
+            bitonic<Avx2Ops<T>>(data, size);
+        }
+#endif
+    };
+
+#ifdef MY_CONTAINER_X86_SIMD
+    template<>
+    struct SimdSort::Sse2Ops<int32_t> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = false;
+
+        static void minMax(int32_t *low, int32_t *high) {
+            const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(low));
+            const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i *>(high));
+            const __m128i greater = _mm_cmpgt_epi32(a, b);
+            _mm_store_si128(reinterpret_cast<__m128i *>(low), _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a)));
+            _mm_store_si128(reinterpret_cast<__m128i *>(high), _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b)));
+        }
+    };
+
+    template<>
+    struct SimdSort::Sse2Ops<uint32_t> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = false;
+
+        static void minMax(uint32_t *low, uint32_t *high) {
+            const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(low));
+            const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i *>(high));
+            // SSE2 only compares signed, flipping the sign bits keeps the unsigned order
+            const __m128i sign = _mm_set1_epi32(INT32_MIN);
+            const __m128i greater = _mm_cmpgt_epi32(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+            _mm_store_si128(reinterpret_cast<__m128i *>(low), _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a)));
+            _mm_store_si128(reinterpret_cast<__m128i *>(high), _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b)));
+        }
+    };
+
+    template<>
+    struct SimdSort::Sse2Ops<float> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = false;
+
+        static void minMax(float *low, float *high) {
+            const __m128 a = _mm_load_ps(low);
+            const __m128 b = _mm_load_ps(high);
+            _mm_store_ps(low, _mm_min_ps(a, b));
+            _mm_store_ps(high, _mm_max_ps(a, b));
+        }
+    };
+
+    template<>
+    struct SimdSort::Sse2Ops<double> {
+        static constexpr size_t lanes = 2;
+        static constexpr bool inRegister = false;
+
+        static void minMax(double *low, double *high) {
+            const __m128d a = _mm_load_pd(low);
+            const __m128d b = _mm_load_pd(high);
+            _mm_store_pd(low, _mm_min_pd(a, b));
+            _mm_store_pd(high, _mm_max_pd(a, b));
+        }
+    };
+
+    // SSE2 cannot compare 64-bit integers, sort() leaves them to std::sort
+    template<>
+    struct SimdSort::Sse2Ops<int64_t> {
+        static constexpr size_t lanes = 1;
+        static constexpr bool inRegister = false;
+
+        static void minMax(int64_t *low, int64_t *high) {
+            const int64_t a = *low;
+            *low = std::min(a, *high);
+            *high = std::max(a, *high);
+        }
+    };
+
+    template<>
+    struct SimdSort::Sse2Ops<uint64_t> {
+        static constexpr size_t lanes = 1;
+        static constexpr bool inRegister = false;
+
+        static void minMax(uint64_t *low, uint64_t *high) {
+            const uint64_t a = *low;
+            *low = std::min(a, *high);
+            *high = std::max(a, *high);
+        }
+    };
+
+    /**
+     * Lanes of a network step inside one AVX2 vector that take the larger of their pair: the lower lane
+     * of a pair sorting down and the upper lane of a pair sorting up.
+     */
+    __attribute__((target("avx2"))) inline __m256i avx2TakeHigh32(const size_t base, const size_t j, const size_t k) {
+        const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(lane, _mm256_set1_epi32(static_cast<int>(j))), zero);
+        const __m256i up = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_add_epi32(lane, _mm256_set1_epi32(static_cast<int>(base))),
+                                                               _mm256_set1_epi32(static_cast<int>(k))), zero);
+        return _mm256_xor_si256(lower, up);
+    }
+
+    __attribute__((target("avx2"))) inline __m256i avx2TakeHigh64(const size_t base, const size_t j, const size_t k) {
+        const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lower = _mm256_cmpeq_epi64(_mm256_and_si256(lane, _mm256_set1_epi64x(static_cast<long long>(j))), zero);
+        const __m256i up = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(lane, _mm256_set1_epi64x(static_cast<long long>(base))),
+                                                               _mm256_set1_epi64x(static_cast<long long>(k))), zero);
+        return _mm256_xor_si256(lower, up);
+    }
+
+    // Permutation moving the partner of each element into its place, for 8 elements of 32 bits or 4 of 64
+    __attribute__((target("avx2"))) inline __m256i avx2Partner32(const size_t j) {
+        return _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(j)));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i avx2Partner64(const size_t j) {
+        return _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(2 * j)));
+    }
+
+    template<>
+    struct SimdSort::Avx2Ops<int32_t> {
+        static constexpr size_t lanes = 8;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(int32_t *low, int32_t *high) {
+            const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(low));
+            const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(high));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(low), _mm256_min_epi32(a, b));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(high), _mm256_max_epi32(a, b));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(int32_t *vector, size_t base, size_t j, size_t k) {
+            const __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(vector));
+            const __m256i partner = _mm256_permutevar8x32_epi32(v, avx2Partner32(j));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(vector),
+                               _mm256_blendv_epi8(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), avx2TakeHigh32(base, j, k)));
+        }
+    };
+
+    template<>
+    struct SimdSort::Avx2Ops<uint32_t> {
+        static constexpr size_t lanes = 8;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(uint32_t *low, uint32_t *high) {
+            const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(low));
+            const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(high));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(low), _mm256_min_epu32(a, b));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(high), _mm256_max_epu32(a, b));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(uint32_t *vector, size_t base, size_t j, size_t k) {
+            const __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(vector));
+            const __m256i partner = _mm256_permutevar8x32_epi32(v, avx2Partner32(j));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(vector),
+                               _mm256_blendv_epi8(_mm256_min_epu32(v, partner), _mm256_max_epu32(v, partner), avx2TakeHigh32(base, j, k)));
+        }
+    };
+
+    template<>
+    struct SimdSort::Avx2Ops<float> {
+        static constexpr size_t lanes = 8;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(float *low, float *high) {
+            const __m256 a = _mm256_load_ps(low);
+            const __m256 b = _mm256_load_ps(high);
+            _mm256_store_ps(low, _mm256_min_ps(a, b));
+            _mm256_store_ps(high, _mm256_max_ps(a, b));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(float *vector, size_t base, size_t j, size_t k) {
+            const __m256 v = _mm256_load_ps(vector);
+            const __m256 partner = _mm256_permutevar8x32_ps(v, avx2Partner32(j));
+            _mm256_store_ps(vector, _mm256_blendv_ps(_mm256_min_ps(v, partner), _mm256_max_ps(v, partner),
+                                                     _mm256_castsi256_ps(avx2TakeHigh32(base, j, k))));
+        }
+    };
+
+    template<>
+    struct SimdSort::Avx2Ops<double> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(double *low, double *high) {
+            const __m256d a = _mm256_load_pd(low);
+            const __m256d b = _mm256_load_pd(high);
+            _mm256_store_pd(low, _mm256_min_pd(a, b));
+            _mm256_store_pd(high, _mm256_max_pd(a, b));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(double *vector, size_t base, size_t j, size_t k) {
+            const __m256d v = _mm256_load_pd(vector);
+            const __m256d partner = _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), avx2Partner64(j)));
+            _mm256_store_pd(vector, _mm256_blendv_pd(_mm256_min_pd(v, partner), _mm256_max_pd(v, partner),
+                                                     _mm256_castsi256_pd(avx2TakeHigh64(base, j, k))));
+        }
+    };
+
+    template<>
+    struct SimdSort::Avx2Ops<int64_t> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(int64_t *low, int64_t *high) {
+            const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(low));
+            const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(high));
+            const __m256i greater = _mm256_cmpgt_epi64(a, b);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(low), _mm256_blendv_epi8(a, b, greater));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(high), _mm256_blendv_epi8(b, a, greater));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(int64_t *vector, size_t base, size_t j, size_t k) {
+            const __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(vector));
+            const __m256i partner = _mm256_permutevar8x32_epi32(v, avx2Partner64(j));
+            const __m256i greater = _mm256_cmpgt_epi64(v, partner);
+            const __m256i low = _mm256_blendv_epi8(v, partner, greater);
+            const __m256i high = _mm256_blendv_epi8(partner, v, greater);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(vector), _mm256_blendv_epi8(low, high, avx2TakeHigh64(base, j, k)));
+        }
+    };
+
+    template<>
+    struct SimdSort::Avx2Ops<uint64_t> {
+        static constexpr size_t lanes = 4;
+        static constexpr bool inRegister = true;
+
+        __attribute__((target("avx2"))) static void minMax(uint64_t *low, uint64_t *high) {
+            const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(low));
+            const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(high));
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+            const __m256i greater = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(low), _mm256_blendv_epi8(a, b, greater));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(high), _mm256_blendv_epi8(b, a, greater));
+        }
+
+        __attribute__((target("avx2"))) static void exchange(uint64_t *vector, size_t base, size_t j, size_t k) {
+            const __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(vector));
+            const __m256i partner = _mm256_permutevar8x32_epi32(v, avx2Partner64(j));
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+            const __m256i greater = _mm256_cmpgt_epi64(_mm256_xor_si256(v, sign), _mm256_xor_si256(partner, sign));
+            const __m256i low = _mm256_blendv_epi8(v, partner, greater);
+            const __m256i high = _mm256_blendv_epi8(partner, v, greater);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(vector), _mm256_blendv_epi8(low, high, avx2TakeHigh64(base, j, k)));
+        }
+    };
+#endif
+}
@@ -0,0 +1,439 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace MyContainerNamespace {
+    /**
+     * Worker threads shared by every sort of every container, started on first use and kept
+     * until the program exits, so a parallel sort does not pay for creating threads.
+     */
+    class SortThreadPool {
+    public:
+        static SortThreadPool &shared() {
+            static SortThreadPool pool;
+            return pool;
+        }
+
+        SortThreadPool(const SortThreadPool &) = delete;
+
+        SortThreadPool &operator=(const SortThreadPool &) = delete;
+
+        ~SortThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        /**
+         * Call fn(0), ..., fn(count - 1) on up to threads threads, the calling one included, and wait
+         * for all of them. Tasks never wait on each other, so sorts from several threads can share the pool.
+         * @param count the number of calls
+         * @param threads the number of threads to use at most
+         * @param fn called with each index once, possibly concurrently
+         * @throws the first exception thrown by fn, after every call has finished
+         */
+        template<typename Fn>
+        void parallelFor(const size_t count, const size_t threads, Fn fn) {
+            struct Batch {
+                std::atomic<size_t> next{0};
+                size_t count = 0;
+                std::mutex mutex;
+                std::condition_variable done;
+                size_t finished = 0;
+                std::exception_ptr error;
+            };
+            auto batch = std::make_shared<Batch>();
+            batch->count = count;
+            // Helpers may only start once everything is done, they then touch batch but never fn
+            const auto work = [batch, &fn] {
+                for (size_t i = batch->next++; i < batch->count; i = batch->next++) {
+                    std::exception_ptr error;
+                    try {
+                        fn(i);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    if (error && !batch->error) {
+                        batch->error = error;
+                    }
+                    if (++batch->finished == batch->count) {
+                        batch->done.notify_all();
+                    }
+                }
+            };
+            const size_t helpers = std::min(threads, count) - 1;
+            if (helpers > 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                while (workers.size() < helpers) {
+                    workers.emplace_back([this] { workerLoop(); });
+                }
+                for (size_t h = 0; h < helpers; ++h) {
+                    tasks.emplace_back(work);
+                }
+            }
+            wake.notify_all();
+            work();
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->done.wait(lock, [&batch] { return batch->finished == batch->count; });
+            if (batch->error) {
+                std::rethrow_exception(batch->error);
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<std::function<void()>> tasks;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        SortThreadPool() = default;
+
+        void workerLoop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+
+    /**
+     * The sort behind the ordered views. Ranges of at least threshold() elements are split into one
+     * chunk per thread, the chunks are sorted concurrently on the SortThreadPool and then merged pairwise,
+     * also concurrently. The result is the same as std::stable_sort: equal elements keep their order.
+     * The comparator is called from several threads at once and must allow that, so the views only
+     * sort in parallel with < and > unless setUserComparators(true) vouches for the user's comparators.
+     */
+    class ParallelSort {
+    public:
+        /**
+         * @param count the number of threads a sort may use, 0 for one per hardware thread, 1 to never sort in parallel
+         */
+        static void setThreads(size_t count) {
+            configuredThreads = count;
+        }
+
+        /**
+         * @return the number of threads a sort uses
+         */
+        static size_t threads() {
+            const size_t count = configuredThreads;
+            if (count != 0) {
+                return count;
+            }
+            const size_t hardware = std::thread::hardware_concurrency();
+            return hardware == 0 ? 1 : hardware;
+        }
+
+        /**
+         * @param elements the smallest range sorted in parallel, below it the threads cost more than they save
+         */
+        static void setThreshold(size_t elements) {
+            configuredThreshold = elements;
+        }
+
+        static size_t threshold() {
+            return configuredThreshold;
+        }
+
+        /**
+         * @param enabled whether views sorted with a user comparator (sortedWith) or by keys of a user type
+         * (sortedBy) are sorted in parallel too, off by default: only turn it on if every such comparator and
+         * key < can be called from several threads at once
+         */
+        static void setUserComparators(bool enabled) {
+            userComparatorsEnabled = enabled;
+        }
+
+        static bool userComparators() {
+            return userComparatorsEnabled;
+        }
+
+        /**
+         * Stable sort of [first, last) with comp, in parallel when the range is large enough.
+         * @param first the first element
+         * @param last one past the last element
+         * @param comp the strict weak order to sort by
+         */
+        template<typename RandomIt, typename Compare>
+        static void stableSort(RandomIt first, RandomIt last, Compare comp) {
+            const size_t size = static_cast<size_t>(last - first);
+            const size_t count = threads();
+            if (count <= 1 || size < threshold() || size < 2 * count) {
+                std::stable_sort(first, last, comp);
+                return;
+            }
+            // chunk c is [bounds[c], bounds[c + 1])
+            std::vector<size_t> bounds(count + 1);
+            for (size_t c = 0; c <= count; ++c) {
+                bounds[c] = size / count * c + std::min(c, size % count);
+            }
+            SortThreadPool &pool = SortThreadPool::shared();
+            pool.parallelFor(count, count, [first, &bounds, &comp](size_t c) {
+                std::stable_sort(first + bounds[c], first + bounds[c + 1], comp);
+            });
+            // Merge neighbouring runs, the left one first, which keeps equal elements in order
+            for (size_t width = 1; width < count; width *= 2) {
+                const size_t merges = (count + 2 * width - 1) / (2 * width);
+                pool.parallelFor(merges, count, [first, &bounds, &comp, width, count](size_t m) {
+                    const size_t left = 2 * width * m;
+                    const size_t middle = std::min(left + width, count);
+                    const size_t right = std::min(left + 2 * width, count);
+                    if (middle < right) {
+                        std::inplace_merge(first + bounds[left], first + bounds[middle], first + bounds[right], comp);
+                    }
+                });
+            }
+        }
+
+    private:
+        static inline std::atomic<size_t> configuredThreads{0};
+        static inline std::atomic<size_t> configuredThreshold{1 << 16};
+        static inline std::atomic<bool> userComparatorsEnabled{false};
+    };
+
+    // Element types ordered by <  the same way as by their bits once transformed: integers and IEEE-754 floats
+    template<typename T>
+    struct RadixSortable : std::bool_constant<sizeof(T) <= 8 &&
+                                              ((std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+                                               (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 &&
+                                                (sizeof(T) == 4 || sizeof(T) == 8)))> {
+    };
+
+    /**
+     * LSD radix sort of RadixSortable elements, one byte per pass, in O(n) instead of O(n log n).
+     * Keys are the bits with the sign bit flipped for signed integers; for floats the negative ones
+     * have all their bits flipped, and -0.0 gets the key of 0.0 so they stay in order like with <.
+     * Each pass is stable, so the result is the one of std::stable_sort with < (or >).
+     * Passes over a byte that is the same in every key are skipped. One byte elements use a counting sort.
+     */
+    class RadixSort {
+    public:
+        static constexpr size_t threshold = 256; // below it std::sort is as fast
+
+        /**
+         * @param first the first element
+         * @param last one past the last element
+         * @param buffer room for last - first elements, unused for one byte elements
+         * @param descending sort with > instead of <
+         */
+        template<typename T>
+        static void sort(T *first, T *last, T *buffer, bool descending) {
+            static_assert(RadixSortable<T>::value, "radix sort needs an integer or IEEE-754 element type");
+            if constexpr (sizeof(T) == 1) {
+                (void) buffer;
+                countingSort(first, last, descending);
+            } else {
+                lsdSort(first, last, buffer, descending);
+            }
+        }
+
+    private:
+        template<typename T>
+        using Key = std::conditional_t<sizeof(T) == 1, uint8_t,
+            std::conditional_t<sizeof(T) == 2, uint16_t,
+                std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+        template<typename T>
+        static Key<T> key(T value) {
+            constexpr Key<T> sign = Key<T>(1) << (8 * sizeof(T) - 1);
+            if constexpr (std::is_floating_point_v<T>) {
+                if (value == 0) {
+                    value = 0; // -0.0 == 0.0
+                }
+                Key<T> bits;
+                std::memcpy(&bits, &value, sizeof(T));
+                return (bits & sign) ? static_cast<Key<T>>(~bits) : static_cast<Key<T>>(bits | sign);
+            } else if constexpr (std::is_signed_v<T>) {
+                return static_cast<Key<T>>(static_cast<Key<T>>(value) ^ sign);
+            } else {
+                return static_cast<Key<T>>(value);
+            }
+        }
+
+        template<typename T>
+        static void countingSort(T *first, T *last, bool descending) {
+            size_t counts[256] = {};
+            for (const T *it = first; it != last; ++it) {
+                ++counts[key(*it)];
+            }
+            constexpr unsigned sign = std::is_signed_v<T> ? 0x80u : 0u;
+            for (size_t b = 0; b < 256; ++b) {
+                const size_t bucket = descending ? 255 - b : b;
+                first = std::fill_n(first, counts[bucket], static_cast<T>(static_cast<uint8_t>(bucket ^ sign)));
+            }
+        }
+
+        template<typename T>
+        static void lsdSort(T *first, T *last, T *buffer, bool descending) {
+            constexpr size_t passes = sizeof(T);
+            const size_t size = static_cast<size_t>(last - first);
+            const Key<T> flip = descending ? static_cast<Key<T>>(~Key<T>(0)) : Key<T>(0);
+            // One scan counts the bytes of every pass
+            size_t counts[passes][256] = {};
+            for (const T *it = first; it != last; ++it) {
+                const Key<T> k = key(*it) ^ flip;
+                for (size_t p = 0; p < passes; ++p) {
+                    ++counts[p][(k >> (8 * p)) & 0xFF];
+                }
+            }
+            T *from = first;
+            T *to = buffer;
+            for (size_t p = 0; p < passes; ++p) {
+                size_t offsets[256];
+                size_t total = 0;
+                bool trivial = false;
+                for (size_t b = 0; b < 256; ++b) {
+                    trivial = trivial || counts[p][b] == size;
+                    offsets[b] = total;
+                    total += counts[p][b];
+                }
+                if (trivial) {
+                    continue;
+                }
+                for (const T *it = from; it != from + size; ++it) {
+                    const Key<T> k = key(*it) ^ flip;
+                    to[offsets[(k >> (8 * p)) & 0xFF]++] = *it;
+                }
+                std::swap(from, to);
+            }
+            if (from != first) {
+                std::memcpy(first, from, size * sizeof(T));
+            }
+        }
+    };
+
+    // T can be compared with <
+    template<typename T, typename = void>
+    struct HasLess : std::false_type {
+    };
+
+    template<typename T>
+    struct HasLess<T, std::void_t<decltype(std::declval<const T &>() < std::declval<const T &>())>> : std::true_type {
+    };
+
+    /**
+     * Natural merge sort for data that is already partly in order. The range is cut into its runs,
+     * non-decreasing or strictly decreasing (reversed in place, which keeps it stable), and the runs
+     * are merged in the order of powersort, which is near optimal for any mix of run lengths.
+     * Sorted or reverse sorted data costs n - 1 comparisons and no moves.
+     * When the runs are short on average the data is too random to gain anything; sort() then
+     * gives up after looking at a small part of it, leaving the range as it was.
+     */
+    class RunSort {
+    public:
+        static constexpr size_t minAverageRun = 32;
+
+        /**
+         * Stable sort of [first, last) with comp if it has few enough runs.
+         * @param first the first element
+         * @param last one past the last element
+         * @param comp the strict weak order to sort by
+         * @return true if the range was sorted, false if it holds too many runs and was not touched
+         */
+        template<typename RandomIt, typename Compare>
+        static bool sort(RandomIt first, RandomIt last, Compare comp) {
+            const size_t size = static_cast<size_t>(last - first);
+            const size_t max_runs = std::max<size_t>(1, size / minAverageRun);
+            struct Run {
+                size_t begin, end;
+                bool descending;
+            };
+            std::vector<Run> runs;
+            for (size_t begin = 0; begin < size;) {
+                size_t end = begin + 1;
+                const bool descending = end < size && comp(first[end], first[end - 1]);
+                if (descending) {
+                    while (end < size && comp(first[end], first[end - 1])) {
+                        ++end;
+                    }
+                } else {
+                    while (end < size && !comp(first[end], first[end - 1])) {
+                        ++end;
+                    }
+                }
+                if (runs.size() == max_runs) {
+                    return false;
+                }
+                runs.push_back({begin, end, descending});
+                begin = end;
+            }
+            for (const Run &run : runs) {
+                if (run.descending) {
+                    std::reverse(first + run.begin, first + run.end);
+                }
+            }
+            // Powersort: a run is merged with its left neighbour once the next boundary is higher in the tree
+            struct Pending {
+                size_t begin;
+                size_t power;
+            };
+            std::vector<Pending> stack;
+            size_t begin = 0;
+            for (size_t r = 1; r < runs.size(); ++r) {
+                const size_t power = nodePower(begin, runs[r].begin, runs[r].end, size);
+                while (!stack.empty() && stack.back().power > power) {
+                    std::inplace_merge(first + stack.back().begin, first + begin, first + runs[r].begin, comp);
+                    begin = stack.back().begin;
+                    stack.pop_back();
+                }
+                stack.push_back({begin, power});
+                begin = runs[r].begin;
+            }
+            while (!stack.empty()) {
+                std::inplace_merge(first + stack.back().begin, first + begin, last, comp);
+                begin = stack.back().begin;
+                stack.pop_back();
+            }
+            return true;
+        }
+
+    private:
+        /**
+         * The depth of the boundary between [begin, middle) and [middle, end) in the perfectly balanced
+         * merge tree over size elements: the first bit where the binary fractions of the two midpoints differ.
+         */
+        static size_t nodePower(size_t begin, size_t middle, size_t end, size_t size) {
+            // midpoints are a / (2 size) and b / (2 size)
+            size_t a = begin + middle;
+            size_t b = middle + end;
+            const size_t whole = 2 * size;
+            size_t power = 0;
+            while (a / whole == b / whole) {
+                a = a % whole * 2;
+                b = b % whole * 2;
+                ++power;
+            }
+            return power;
+        }
+    };
+}
@@ -22,6 +22,18 @@ PeopleClass::People& PeopleClass::People::operator=(const People& other) {
     return *this;
 }
 
+PeopleClass::People::People(People&& other) noexcept
+  : name(std::move(other.name)), age(other.age)
+{}
+
+PeopleClass::People& PeopleClass::People::operator=(People&& other) noexcept {
+    if (this != &other) {
+        name = std::move(other.name);
+        age  = other.age;
+    }
+    return *this;
+}
+
 int PeopleClass::People::getAge() const {
     return static_cast<int>(age);
 }
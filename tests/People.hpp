@@ -12,6 +12,8 @@ namespace PeopleClass {
         ~People();
         People(const People& other);
         People& operator=(const People& other);
+        People(People&& other) noexcept;
+        People& operator=(People&& other) noexcept;
         int getAge() const;
         string getName() const;
         bool operator==(const People& other) const;
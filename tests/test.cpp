@@ -3,6 +3,14 @@
 #include "../container/MyContainer.hpp"
 #include "People.hpp"
 #include <sstream>
+#include <list>
+#include <memory_resource>
+#include <thread>
+#include <cmath>
+#include <random>
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
 
 using namespace PeopleClass;
 
@@ -2120,4 +2128,2397 @@ TEST_CASE("MyContainer<People>") {
         CHECK(names == std::vector<std::string>{"Zed", "Mike", "Anna"});
     }
 
-}
\ No newline at end of file
+}
+//////// MOVE SEMANTICS TESTS //////////
+namespace {
+    // Counts copies and moves so tests can check which path the container took
+    struct Tracked {
+        static int copies;
+        static int moves;
+        int value;
+
+        Tracked(int value = 0) : value(value) {}
+        Tracked(const Tracked &other) : value(other.value) { ++copies; }
+        Tracked(Tracked &&other) noexcept : value(other.value) { ++moves; }
+
+        Tracked &operator=(const Tracked &other) {
+            value = other.value;
+            ++copies;
+            return *this;
+        }
+
+        Tracked &operator=(Tracked &&other) noexcept {
+            value = other.value;
+            ++moves;
+            return *this;
+        }
+
+        bool operator==(const Tracked &other) const { return value == other.value; }
+        bool operator!=(const Tracked &other) const { return value != other.value; }
+        bool operator<(const Tracked &other) const { return value < other.value; }
+        bool operator>(const Tracked &other) const { return value > other.value; }
+
+        static void reset() { copies = moves = 0; }
+    };
+
+    int Tracked::copies = 0;
+    int Tracked::moves = 0;
+}
+
+TEST_CASE("MyContainer move semantics") {
+    Tracked::reset();
+
+    SUBCASE("Growth moves instead of copying") {
+        MyContainer<Tracked> c;
+        for (int i = 0; i < 100; ++i) {
+            c.add(Tracked(i));
+        }
+        CHECK(c.size() == 100);
+        CHECK(Tracked::copies == 0);
+        CHECK(c.at(99).value == 99);
+    }
+
+    SUBCASE("add(const T&) copies exactly once") {
+        MyContainer<Tracked> c;
+        Tracked t(5);
+        for (int i = 0; i < 10; ++i) {
+            c.add(t);
+        }
+        CHECK(Tracked::copies == 10);
+    }
+
+    SUBCASE("emplace constructs in place") {
+        MyContainer<People> people;
+        People &p = people.emplace("Dana", 33);
+        CHECK(p.getName() == "Dana");
+        CHECK(people.at(0).getAge() == 33);
+    }
+
+    SUBCASE("emplace from an element of the same container") {
+        MyContainer<std::string> c;
+        c.add("first");
+        c.add(c.at(0)); // forces a resize while referencing the old buffer
+        CHECK(c.size() == 2);
+        CHECK(c.at(1) == "first");
+    }
+
+    SUBCASE("Move constructor steals the buffer") {
+        MyContainer<Tracked> c;
+        c.add(Tracked(1));
+        c.add(Tracked(2));
+        Tracked::reset();
+        MyContainer<Tracked> moved(std::move(c));
+        CHECK(Tracked::copies == 0);
+        CHECK(Tracked::moves == 0);
+        CHECK(moved.size() == 2);
+        CHECK(c.isEmpty());
+        c.add(Tracked(3)); // moved-from container stays usable
+        CHECK(c.size() == 1);
+    }
+
+    SUBCASE("Move assignment steals the buffer") {
+        MyContainer<std::string> c;
+        c.add("a");
+        c.add("b");
+        MyContainer<std::string> target;
+        target.add("old");
+        target = std::move(c);
+        CHECK(target.size() == 2);
+        CHECK(target.contains("b"));
+        CHECK_FALSE(target.contains("old"));
+        CHECK(c.isEmpty());
+    }
+
+    SUBCASE("Remove keeps the remaining elements intact") {
+        MyContainer<std::string> c;
+        c.add("x");
+        c.add("y");
+        c.add("x");
+        c.add("z");
+        c.remove("x");
+        CHECK(c.size() == 2);
+        CHECK(c.at(0) == "y");
+        CHECK(c.at(1) == "z");
+    }
+}
+
+//////// RAW STORAGE TESTS //////////
+namespace {
+    // Has no default constructor and counts how many objects are alive
+    struct NoDefault {
+        static int alive;
+        int value;
+
+        explicit NoDefault(int value) : value(value) { ++alive; }
+        NoDefault(const NoDefault &other) : value(other.value) { ++alive; }
+        NoDefault(NoDefault &&other) noexcept : value(other.value) { ++alive; }
+        NoDefault &operator=(const NoDefault &other) = default;
+        NoDefault &operator=(NoDefault &&other) noexcept = default;
+        ~NoDefault() { --alive; }
+
+        bool operator==(const NoDefault &other) const { return value == other.value; }
+        bool operator!=(const NoDefault &other) const { return value != other.value; }
+        bool operator<(const NoDefault &other) const { return value < other.value; }
+        bool operator>(const NoDefault &other) const { return value > other.value; }
+    };
+
+    int NoDefault::alive = 0;
+}
+
+TEST_CASE("MyContainer raw storage") {
+    NoDefault::alive = 0;
+
+    SUBCASE("Works without a default constructor") {
+        {
+            MyContainer<NoDefault> c;
+            for (int i = 5; i > 0; --i) {
+                c.emplace(i);
+            }
+            std::vector<int> asc;
+            for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+                asc.push_back(it->value);
+            }
+            CHECK(asc == std::vector<int>{1, 2, 3, 4, 5});
+
+            std::vector<int> cross;
+            for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+                cross.push_back(it->value);
+            }
+            CHECK(cross == std::vector<int>{1, 5, 2, 4, 3});
+
+            MyContainer<NoDefault> copy(c);
+            copy.remove(NoDefault(3));
+            CHECK(copy.size() == 4);
+            CHECK(c.size() == 5);
+        }
+        // Every constructed element was destroyed, including the ordered view buffers
+        CHECK(NoDefault::alive == 0);
+    }
+
+    SUBCASE("Only live elements exist, spare capacity holds no objects") {
+        MyContainer<NoDefault> c;
+        for (int i = 0; i < 5; ++i) {
+            c.emplace(i); // capacity grows to 8
+        }
+        CHECK(NoDefault::alive == 5);
+        c.remove(NoDefault(0));
+        CHECK(NoDefault::alive == 4);
+    }
+
+    SUBCASE("Middle out order with an even number of elements") {
+        MyContainer<int> c;
+        for (int i = 1; i <= 4; ++i) {
+            c.add(i);
+        }
+        std::vector<int> order;
+        for (auto it = c.beginMiddleOutOrder(); it != c.endMiddleOutOrder(); ++it) {
+            order.push_back(*it);
+        }
+        CHECK(order == std::vector<int>{3, 4, 2, 1});
+    }
+}
+
+//////// MEMORY RESOURCE TESTS //////////
+namespace {
+    // Forwards to the default resource and counts the live allocations
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t live = 0;
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
+
+TEST_CASE("MyContainer memory resource") {
+    SUBCASE("Default constructor uses the default resource") {
+        MyContainer<int> c;
+        CHECK(c.getMemoryResource() == std::pmr::get_default_resource());
+    }
+
+    SUBCASE("Elements and ordered views come from the arena") {
+        alignas(std::max_align_t) unsigned char arena[4096];
+        // null upstream: any allocation that does not fit the arena would throw
+        std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+        MyContainer<int> c(&pool);
+        for (int i = 10; i > 0; --i) {
+            c.add(i);
+        }
+        int expected = 1;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            CHECK(*it == expected++);
+        }
+        size_t visited = 0;
+        for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+            ++visited;
+        }
+        CHECK(visited == 10);
+        c.remove(5);
+        CHECK(c.size() == 9);
+    }
+
+    SUBCASE("Every allocation is returned to the resource") {
+        CountingResource counting;
+        {
+            MyContainer<std::string> c(&counting);
+            for (int i = 0; i < 20; ++i) {
+                c.add(std::string(40, static_cast<char>('a' + i)));
+            }
+            CHECK(*c.beginDescendingOrder() == std::string(40, 't'));
+            c.remove(std::string(40, 'a'));
+            CHECK(counting.allocations > 0);
+        }
+        CHECK(counting.live == 0);
+    }
+
+    SUBCASE("Copy and move keep std::pmr semantics") {
+        CountingResource first, second;
+        MyContainer<int> a(&first);
+        a.add(1);
+        a.add(2);
+
+        MyContainer<int> copy(a);
+        CHECK(copy.getMemoryResource() == std::pmr::get_default_resource());
+
+        MyContainer<int> placed(a, &second);
+        CHECK(placed.getMemoryResource() == &second);
+        CHECK(placed.size() == 2);
+
+        MyContainer<int> moved(std::move(a));
+        CHECK(moved.getMemoryResource() == &first);
+
+        // different resources: elements are moved into the target's own storage
+        placed = std::move(moved);
+        CHECK(placed.getMemoryResource() == &second);
+        CHECK(placed.contains(1));
+        CHECK(placed.contains(2));
+        CHECK(moved.isEmpty());
+        CHECK(first.live == 0);
+    }
+}
+
+//////// INLINE CAPACITY TESTS //////////
+TEST_CASE("MyContainer inline capacity") {
+    CountingResource counting;
+
+    SUBCASE("Small containers never touch the memory resource") {
+        MyContainer<int, 16> c(&counting);
+        for (int i = 16; i > 0; --i) {
+            c.add(i);
+        }
+        std::vector<int> cross;
+        for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+            cross.push_back(*it);
+        }
+        CHECK(cross.front() == 1);
+        CHECK(cross[1] == 16);
+        CHECK(*c.beginAscendingOrder() == 1);
+        CHECK(*c.beginMiddleOutOrder() == 8);
+        c.remove(7);
+        CHECK(c.size() == 15);
+        CHECK(counting.allocations == 0);
+    }
+
+    SUBCASE("Overflow moves to the heap and shrinking comes back inline") {
+        MyContainer<std::string, 4> c(&counting);
+        for (int i = 0; i < 10; ++i) {
+            c.add(std::to_string(i));
+        }
+        CHECK(counting.live == 1);
+        for (int i = 0; i < 9; ++i) {
+            c.remove(std::to_string(i));
+        }
+        CHECK(c.size() == 1);
+        CHECK(c.at(0) == "9");
+        CHECK(counting.live == 0);
+    }
+
+    SUBCASE("Moving an inline container moves its elements") {
+        MyContainer<std::string, 8> c(&counting);
+        c.add("left");
+        c.add("right");
+        MyContainer<std::string, 8> moved(std::move(c));
+        CHECK(moved.size() == 2);
+        CHECK(moved.at(1) == "right");
+        CHECK(c.isEmpty());
+
+        MyContainer<std::string, 8> assigned(&counting);
+        assigned = std::move(moved);
+        CHECK(assigned.size() == 2);
+        CHECK(assigned.at(0) == "left");
+
+        MyContainer<std::string, 8> copy(assigned);
+        CHECK(copy.size() == 2);
+        CHECK(counting.allocations == 0);
+    }
+
+    SUBCASE("Large views still use the heap") {
+        MyContainer<int, 2> c(&counting);
+        for (int i = 0; i < 5; ++i) {
+            c.add(i);
+        }
+        const size_t before = counting.allocations;
+        auto it = c.beginDescendingOrder();
+        CHECK(*it == 4);
+        // the ascending index it is derived from and the descending view itself
+        CHECK(counting.allocations == before + 2);
+    }
+}
+
+//////// CAPACITY AND GROWTH POLICY TESTS //////////
+TEST_CASE("MyContainer capacity and growth policy") {
+    SUBCASE("Default policy doubles and halves") {
+        MyContainer<int> c;
+        CHECK(c.capacity() == 0);
+        for (int i = 0; i < 5; ++i) {
+            c.add(i);
+        }
+        CHECK(c.capacity() == 8);
+        c.remove(0);
+        c.remove(1);
+        c.remove(2);
+        CHECK(c.size() == 2);
+        CHECK(c.capacity() == 8);
+        c.remove(3); // 1 < 8 / 4
+        CHECK(c.capacity() == 4);
+        c.remove(4);
+        CHECK(c.capacity() == 0);
+    }
+
+    SUBCASE("reserve presizes without changing the elements") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add(1);
+        c.reserve(1000);
+        CHECK(c.capacity() == 1000);
+        const size_t before = counting.allocations;
+        for (int i = 0; i < 999; ++i) {
+            c.add(i);
+        }
+        CHECK(counting.allocations == before);
+        CHECK(c.at(0) == 1);
+        c.reserve(10); // never shrinks
+        CHECK(c.capacity() == 1000);
+    }
+
+    SUBCASE("shrinkToFit gives back unused capacity") {
+        MyContainer<std::string> c;
+        c.reserve(64);
+        c.add("a");
+        c.add("b");
+        c.shrinkToFit();
+        CHECK(c.capacity() == 2);
+        CHECK(c.at(1) == "b");
+
+        MyContainer<int, 8> small;
+        small.reserve(100);
+        small.add(1);
+        small.shrinkToFit(); // back into the inline buffer
+        CHECK(small.capacity() == 8);
+        CHECK(small.at(0) == 1);
+    }
+
+    SUBCASE("reserve during iteration throws ActiveIterator") {
+        MyContainer<int> c;
+        c.add(1);
+        auto it = c.begin();
+        CHECK_THROWS_AS(c.reserve(100), ActiveIterator);
+        CHECK_NOTHROW(c.reserve(1)); // nothing to reallocate
+    }
+
+    SUBCASE("1.5x growth") {
+        MyContainer<int, 0, OneAndHalfGrowth> c;
+        std::vector<size_t> capacities;
+        for (int i = 0; i < 10; ++i) {
+            c.add(i);
+            if (capacities.empty() || capacities.back() != c.capacity()) {
+                capacities.push_back(c.capacity());
+            }
+        }
+        CHECK(capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13});
+    }
+
+    SUBCASE("Never shrink keeps the memory") {
+        MyContainer<int, 0, NeverShrinkGrowth> c;
+        for (int i = 0; i < 100; ++i) {
+            c.add(i);
+        }
+        const size_t grown = c.capacity();
+        for (int i = 0; i < 100; ++i) {
+            c.remove(i);
+        }
+        CHECK(c.isEmpty());
+        CHECK(c.capacity() == grown);
+        c.shrinkToFit();
+        CHECK(c.capacity() == 0);
+    }
+}
+
+//////// BULK INSERTION TESTS //////////
+TEST_CASE("MyContainer bulk insertion") {
+    CountingResource counting;
+
+    SUBCASE("addRange from a vector allocates once") {
+        std::vector<int> values(1000);
+        for (int i = 0; i < 1000; ++i) {
+            values[i] = i;
+        }
+        MyContainer<int> c(&counting);
+        c.addRange(values.begin(), values.end());
+        CHECK(c.size() == 1000);
+        CHECK(c.at(999) == 999);
+        CHECK(counting.allocations == 1);
+    }
+
+    SUBCASE("addRange from a list and from a single-pass stream") {
+        std::list<std::string> words = {"b", "a", "c"};
+        MyContainer<std::string> c;
+        c.addRange(words.begin(), words.end());
+        CHECK(c.size() == 3);
+        CHECK(*c.beginAscendingOrder() == "a");
+
+        std::istringstream in("4 5 6");
+        MyContainer<int> numbers;
+        numbers.addRange(std::istream_iterator<int>(in), std::istream_iterator<int>());
+        CHECK(numbers.size() == 3);
+        CHECK(numbers.at(2) == 6);
+    }
+
+    SUBCASE("add(initializer_list) and the range constructor") {
+        MyContainer<int> c;
+        c.add({3, 1, 2});
+        c.add({4});
+        CHECK(c.size() == 4);
+        CHECK(c.at(3) == 4);
+
+        const double raw[] = {1.5, 2.5};
+        MyContainer<double> fromArray(raw, raw + 2);
+        CHECK(fromArray.size() == 2);
+        CHECK(fromArray.at(1) == 2.5);
+
+        std::vector<People> people = {{"Ann", 30}, {"Bob", 40}};
+        MyContainer<People> fromVector(people.begin(), people.end(), &counting);
+        CHECK(fromVector.size() == 2);
+        CHECK(fromVector.getMemoryResource() == &counting);
+    }
+
+    SUBCASE("append copies from a contiguous array, also from itself") {
+        MyContainer<int> c;
+        const int values[] = {1, 2, 3};
+        c.append(values, 3);
+        c.append(&c.at(0), c.size()); // the source is freed by the reallocation
+        CHECK(c.size() == 6);
+        CHECK(c.at(5) == 3);
+
+        MyContainer<std::string> words;
+        words.add("x");
+        words.append(&words.at(0), 1);
+        CHECK(words.at(1) == "x");
+    }
+
+    SUBCASE("Appending nothing keeps the views") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add({3, 1, 2});
+        CHECK(*c.beginAscendingOrder() == 1);
+        const size_t before = counting.allocations;
+        const int values[] = {0};
+        c.append(values, 0);
+        CHECK(*c.beginAscendingOrder() == 1);
+        CHECK(counting.allocations == before);
+        CHECK(c.size() == 3);
+    }
+
+    SUBCASE("Bulk insertion during iteration throws ActiveIterator") {
+        MyContainer<int> c;
+        c.add(1);
+        auto it = c.begin();
+        CHECK_THROWS_AS(c.add({2, 3}), ActiveIterator);
+        CHECK(c.size() == 1);
+    }
+}
+
+//////// TRIVIALLY COPYABLE FAST PATH TESTS //////////
+namespace {
+    struct alignas(64) Wide {
+        int value;
+
+        bool operator==(const Wide &other) const { return value == other.value; }
+        bool operator!=(const Wide &other) const { return value != other.value; }
+        bool operator<(const Wide &other) const { return value < other.value; }
+        bool operator>(const Wide &other) const { return value > other.value; }
+    };
+}
+
+TEST_CASE("MyContainer trivially copyable fast path") {
+    SUBCASE("Growth through ReallocResource keeps every element") {
+        MyContainer<size_t> c(reallocResource());
+        for (size_t i = 0; i < 20000; ++i) {
+            c.add(i);
+        }
+        bool intact = true;
+        for (size_t i = 0; i < c.size(); ++i) {
+            intact = intact && c.at(i) == i;
+        }
+        CHECK(intact);
+        for (size_t i = 0; i < 100; ++i) {
+            c.remove(i);
+        }
+        CHECK(c.size() == 19900);
+        CHECK(c.at(0) == 100);
+        c.shrinkToFit();
+        CHECK(c.capacity() == 19900);
+    }
+
+    SUBCASE("Adding an element of the container while it reallocates") {
+        MyContainer<double> c(reallocResource());
+        c.add(1.5);
+        for (int i = 0; i < 20; ++i) {
+            c.add(c.at(0));
+        }
+        c.append(&c.at(0), c.size());
+        CHECK(c.size() == 42);
+        CHECK(c.at(41) == 1.5);
+    }
+
+    SUBCASE("Over-aligned elements keep their alignment") {
+        MyContainer<Wide, 2> c(reallocResource());
+        for (int i = 0; i < 50; ++i) {
+            c.add(Wide{i});
+        }
+        CHECK(reinterpret_cast<uintptr_t>(&c.at(0)) % 64 == 0);
+        CHECK(c.at(49).value == 49);
+    }
+
+    SUBCASE("Copies of trivially copyable elements") {
+        MyContainer<char> c;
+        c.add({'a', 'b', 'c'});
+        MyContainer<char> copy(c);
+        CHECK(copy.size() == 3);
+        CHECK(copy.at(2) == 'c');
+    }
+}
+
+//////// CACHED VIEW TESTS //////////
+
+TEST_CASE("MyContainer cached ordered views") {
+    SUBCASE("Repeated traversals reuse the view") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add({5, 3, 9, 1});
+        const size_t before = counting.allocations;
+        for (int round = 0; round < 3; ++round) {
+            vector<int> seen;
+            for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+                seen.push_back(*it);
+            }
+            CHECK(seen == vector<int>{1, 3, 5, 9});
+        }
+        CHECK(counting.allocations == before + 1);
+    }
+
+    SUBCASE("Side cross reuses the ascending view") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add({5, 3, 9, 1});
+        c.beginAscendingOrder();
+        const size_t before = counting.allocations;
+        vector<int> seen;
+        for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        CHECK(seen == vector<int>{1, 9, 3, 5});
+        CHECK(counting.allocations == before); // walks the ascending view, no side cross buffer
+    }
+
+    SUBCASE("Mutations invalidate the views") {
+        MyContainer<int> c;
+        c.add({5, 3, 9});
+        CHECK(*c.beginAscendingOrder() == 3);
+        c.add(1);
+        CHECK(*c.beginAscendingOrder() == 1);
+        c.remove(1);
+        CHECK(*c.beginAscendingOrder() == 3);
+        c.at(1) = 0;
+        CHECK(*c.beginAscendingOrder() == 0);
+        *c.begin() = -1;
+        CHECK(*c.beginAscendingOrder() == -1);
+        CHECK(*c.beginReverseOrder() == 9);
+        c.add(7);
+        CHECK(*c.beginReverseOrder() == 7);
+    }
+
+    SUBCASE("Read-only access keeps the views") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add({2, 1});
+        c.beginDescendingOrder();
+        const size_t before = counting.allocations;
+        CHECK(std::as_const(c).at(0) == 2);
+        CHECK(c.contains(1));
+        CHECK(*c.beginDescendingOrder() == 2);
+        CHECK(counting.allocations == before);
+    }
+
+    SUBCASE("Non-const reads inside an ordered loop keep its end") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        c.add({3, 1, 2});
+        vector<int> seen;
+        auto ascending = c.beginAscendingOrder();
+        size_t started = counting.allocations;
+        for (; ascending != c.endAscendingOrder(); ++ascending) {
+            seen.push_back(*ascending + c.at(0) - 3);
+        }
+        CHECK(seen == vector<int>{1, 2, 3});
+        CHECK(counting.allocations == started); // the end is not sorted again at every step
+        size_t inner = 0;
+        auto descending = c.beginDescendingOrder();
+        started = counting.allocations;
+        for (; descending != c.endDescendingOrder(); ++descending) {
+            for (auto it = c.begin(); it != c.end(); ++it) {
+                ++inner;
+            }
+            CHECK(c.find(*descending) != c.end());
+        }
+        CHECK(inner == 9);
+        CHECK(counting.allocations == started);
+        size_t crossed = 0;
+        for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+            c.at(1);
+            ++crossed;
+        }
+        CHECK(crossed == 3);
+        size_t lazy = 0;
+        for (auto it = c.beginLazyAscendingOrder(); it != c.endLazyAscendingOrder(); ++it) {
+            c.at(2);
+            ++lazy;
+        }
+        CHECK(lazy == 3);
+    }
+
+    SUBCASE("Writes in place are settled by the next add, remove or copy") {
+        MyContainer<int> c;
+        c.add({1, 2, 3, 4});
+        CHECK(*c.beginAscendingOrder() == 1); // indexed, and known to be in order
+        c.at(0) = 9;
+        MyContainer<int> copy(c);
+        CHECK(*copy.beginAscendingOrder() == 2);
+        c.remove(3);
+        vector<int> seen;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        CHECK(seen == vector<int>{2, 4, 9});
+        *c.begin() = 0;
+        c.add(5);
+        CHECK(*c.beginAscendingOrder() == 0);
+        CHECK(*c.beginDescendingOrder() == 5);
+    }
+
+    SUBCASE("Element iterators still block adds and removes") {
+        MyContainer<int> c;
+        c.add({1, 2});
+        {
+            auto it = c.begin();
+            auto copy = it;
+            ++copy;
+            CHECK_THROWS_AS(c.add(3), ActiveIterator);
+            CHECK_THROWS_AS(c.remove(1), ActiveIterator);
+        }
+        {
+            auto view = c.reverse();
+            CHECK_THROWS_AS(c.add(3), ActiveIterator);
+        }
+        CHECK_NOTHROW(c.add(3));
+        CHECK(c.size() == 3);
+    }
+
+    SUBCASE("Different orders can be iterated at the same time") {
+        MyContainer<int> c;
+        c.add({4, 2, 8, 6});
+        vector<pair<int, int>> pairs;
+        auto desc = c.beginDescendingOrder();
+        for (auto asc = c.beginAscendingOrder(); asc != c.endAscendingOrder(); ++asc, ++desc) {
+            pairs.emplace_back(*asc, *desc);
+        }
+        CHECK(pairs == vector<pair<int, int>>{{2, 8}, {4, 6}, {6, 4}, {8, 2}});
+    }
+
+    SUBCASE("Small views use the inline storage") {
+        CountingResource counting;
+        MyContainer<int, 4> c(&counting);
+        c.add({3, 1, 2});
+        vector<int> seen;
+        for (auto it = c.beginMiddleOutOrder(); it != c.endMiddleOutOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        CHECK(seen == vector<int>{1, 2, 3, 1, 2, 3});
+        CHECK(counting.allocations == 0);
+    }
+}
+
+//////// SORTED INDEX TESTS //////////
+
+namespace {
+    // int that counts how often it is compared with <
+    struct Compared {
+        static size_t comparisons;
+        int value;
+
+        bool operator<(const Compared &other) const {
+            ++comparisons;
+            return value < other.value;
+        }
+
+        bool operator==(const Compared &other) const { return value == other.value; }
+
+        bool operator!=(const Compared &other) const { return value != other.value; }
+    };
+
+    size_t Compared::comparisons = 0;
+
+    template<typename Container>
+    vector<int> ascendingValues(Container &c) {
+        vector<int> values;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            values.push_back(*it);
+        }
+        return values;
+    }
+}
+
+TEST_CASE("MyContainer sorted index") {
+    SUBCASE("Batches of adds and removes match a full sort") {
+        MyContainer<int> c;
+        vector<int> reference;
+        unsigned seed = 7;
+        for (int round = 0; round < 40; ++round) {
+            for (int i = 0; i < 25; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                const int value = static_cast<int>(seed >> 16) % 200;
+                c.add(value);
+                reference.push_back(value);
+            }
+            if (round % 3 == 2) {
+                const int gone = reference[reference.size() / 2];
+                c.remove(gone);
+                reference.erase(std::remove(reference.begin(), reference.end(), gone), reference.end());
+            }
+            vector<int> sorted = reference;
+            std::sort(sorted.begin(), sorted.end());
+            REQUIRE(ascendingValues(c) == sorted);
+
+            vector<int> descending;
+            for (auto it = c.beginDescendingOrder(); it != c.endDescendingOrder(); ++it) {
+                descending.push_back(*it);
+            }
+            CHECK(descending == vector<int>(sorted.rbegin(), sorted.rend()));
+            CHECK(*c.beginSideCrossOrder() == sorted.front());
+            CHECK(*++c.beginSideCrossOrder() == sorted.back());
+        }
+    }
+
+    SUBCASE("New elements are merged without sorting everything again") {
+        MyContainer<Compared> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(Compared{(i * 7919) % 1000});
+        }
+        c.beginAscendingOrder();
+        for (int i = 0; i < 10; ++i) {
+            c.add(Compared{i * 100 + 50});
+        }
+        Compared::comparisons = 0;
+        CHECK(c.beginAscendingOrder()->value == 0);
+        // n + k log k, a full sort would need about n log n = 10000
+        CHECK(Compared::comparisons < 1500);
+
+        Compared::comparisons = 0;
+        c.remove(Compared{500});
+        CHECK(Compared::comparisons < 50);
+        Compared::comparisons = 0;
+        auto it = c.beginAscendingOrder();
+        for (int i = 0; i < 500; ++i) {
+            ++it;
+        }
+        CHECK(it->value == 495); // 0..494 and 50, 150, 250, 350, 450 come before
+        CHECK(Compared::comparisons < 1500);
+    }
+
+    SUBCASE("Equal elements stay in insertion order") {
+        MyContainer<People> c;
+        c.add({"Zoe", 25});
+        c.add({"Mike", 20});
+        c.beginAscendingOrder();
+        c.add({"Amy", 25});
+        c.add({"Ben", 20});
+        vector<string> ascending;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            ascending.push_back(it->getName());
+        }
+        CHECK(ascending == vector<string>{"Mike", "Ben", "Zoe", "Amy"});
+        vector<string> descending;
+        for (auto it = c.beginDescendingOrder(); it != c.endDescendingOrder(); ++it) {
+            descending.push_back(it->getName());
+        }
+        CHECK(descending == vector<string>{"Zoe", "Amy", "Mike", "Ben"});
+    }
+
+    SUBCASE("Writing an element rebuilds the index") {
+        MyContainer<int> c;
+        c.add({4, 8, 6});
+        c.beginAscendingOrder();
+        c.at(1) = 1;
+        c.add(5);
+        CHECK(ascendingValues(c) == vector<int>{1, 4, 5, 6});
+        *c.begin() = 9;
+        CHECK(ascendingValues(c) == vector<int>{1, 5, 6, 9});
+    }
+
+    SUBCASE("Views in use are not replaced under their iterators") {
+        MyContainer<int> c;
+        c.add({3, 1, 2});
+        c.beginAscendingOrder();
+        c.add(0);
+        auto reverse = c.beginReverseOrder();
+        auto ascending = c.beginAscendingOrder();
+        CHECK(*ascending == 0);
+        auto first = c.beginSortedWith(std::greater<int>());
+        auto second = c.beginSortedWith(std::less<int>());
+        CHECK(*first == 3);
+        CHECK(*second == 0);
+        CHECK(*reverse == 0);
+    }
+}
+
+//////// PERMUTATION VIEW TESTS //////////
+
+TEST_CASE("MyContainer index permutation views") {
+    SUBCASE("Large elements are not copied into a view") {
+        MyContainer<Tracked> c;
+        for (int i = 0; i < 50; ++i) {
+            c.add(Tracked((i * 17) % 50));
+        }
+        Tracked::reset();
+        vector<int> seen;
+        for (auto it = c.beginDescendingOrder(); it != c.endDescendingOrder(); ++it) {
+            seen.push_back(it->value);
+        }
+        for (auto it = c.beginMiddleOutOrder(); it != c.endMiddleOutOrder(); ++it) {
+            seen.push_back(it->value);
+        }
+        CHECK(Tracked::copies == 0);
+        CHECK(seen.front() == 49);
+        CHECK(seen.size() == 100);
+    }
+
+    SUBCASE("Iterators of a permuted view reach the elements themselves") {
+        MyContainer<string> c;
+        c.add({"pear", "apple", "fig"});
+        auto it = c.beginAscendingOrder();
+        CHECK(&*it == &std::as_const(c).at(1));
+        CHECK(&it[2] == &std::as_const(c).at(0));
+
+        MyContainer<int> small;
+        small.add({3, 1});
+        CHECK(&*small.beginAscendingOrder() != &std::as_const(small).at(1));
+    }
+
+    SUBCASE("Big trivially copyable elements use indices too") {
+        struct Big {
+            int key;
+            char payload[60];
+
+            bool operator<(const Big &other) const { return key < other.key; }
+        };
+        CountingResource counting;
+        MyContainer<Big> c(&counting);
+        for (int i = 0; i < 64; ++i) {
+            c.add(Big{63 - i, {}});
+        }
+        vector<int> keys;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            keys.push_back(it->key);
+        }
+        CHECK(keys.front() == 0);
+        CHECK(keys.back() == 63);
+        CHECK(&*c.beginAscendingOrder() == &std::as_const(c).at(63));
+    }
+
+    SUBCASE("The index follows adds and removes") {
+        MyContainer<People> c;
+        c.add({"Zoe", 30});
+        c.add({"Ben", 20});
+        c.add({"Amy", 40});
+        c.beginAscendingOrder();
+        c.remove({"Ben", 20});
+        c.add({"Kim", 10});
+        c.add({"Lee", 35});
+        vector<string> names;
+        for (auto it = c.beginAscendingOrder(); it != c.endAscendingOrder(); ++it) {
+            names.push_back(it->getName());
+        }
+        CHECK(names == vector<string>{"Kim", "Zoe", "Lee", "Amy"});
+        vector<string> cross;
+        for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+            cross.push_back(it->getName());
+        }
+        CHECK(cross == vector<string>{"Kim", "Amy", "Zoe", "Lee"});
+    }
+
+    SUBCASE("Small permuted views use the inline storage") {
+        CountingResource counting;
+        MyContainer<string, 4> c(&counting);
+        c.add({"b", "a", "c"});
+        CHECK(*c.beginAscendingOrder() == "a");
+        CHECK(*c.beginDescendingOrder() == "c");
+        CHECK(*c.beginSortedWith(std::greater<string>()) == "c");
+        CHECK(counting.allocations == 0);
+    }
+}
+
+//////// ON THE FLY ORDER TESTS //////////
+
+TEST_CASE("MyContainer reverse and middle-out without a view") {
+    SUBCASE("Starting a traversal allocates and copies nothing") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        for (int i = 0; i < 1000; ++i) {
+            c.add(i);
+        }
+        const size_t before = counting.allocations;
+        for (int round = 0; round < 100; ++round) {
+            CHECK(*c.beginReverseOrder() == 999);
+            CHECK(*c.beginMiddleOutOrder() == 500);
+        }
+        CHECK(counting.allocations == before);
+    }
+
+    SUBCASE("Orders match the element positions") {
+        for (int n = 0; n < 8; ++n) {
+            MyContainer<int> c;
+            for (int i = 0; i < n; ++i) {
+                c.add(i);
+            }
+            vector<int> reverse;
+            for (auto it = c.beginReverseOrder(); it != c.endReverseOrder(); ++it) {
+                reverse.push_back(*it);
+            }
+            vector<int> expected;
+            for (int i = n - 1; i >= 0; --i) {
+                expected.push_back(i);
+            }
+            CHECK(reverse == expected);
+
+            vector<int> middle;
+            for (auto it = c.beginMiddleOutOrder(); it != c.endMiddleOutOrder(); ++it) {
+                middle.push_back(*it);
+            }
+            vector<int> sorted = middle;
+            std::sort(sorted.begin(), sorted.end());
+            vector<int> positions(static_cast<size_t>(n));
+            for (int i = 0; i < n; ++i) {
+                positions[static_cast<size_t>(i)] = i;
+            }
+            CHECK(sorted == positions); // every element exactly once
+            if (n > 0) {
+                CHECK(middle.front() == n / 2);
+            }
+        }
+    }
+
+    SUBCASE("Middle-out of an even and an odd count") {
+        MyContainer<int> even;
+        even.add({1, 2, 3, 4});
+        vector<int> seen;
+        for (auto it = even.beginMiddleOutOrder(); it != even.endMiddleOutOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        CHECK(seen == vector<int>{3, 4, 2, 1});
+
+        MyContainer<int> odd;
+        odd.add({1, 2, 3, 4, 5});
+        seen.clear();
+        for (auto it = odd.beginMiddleOutOrder(); it != odd.endMiddleOutOrder(); ++it) {
+            seen.push_back(*it);
+        }
+        CHECK(seen == vector<int>{3, 4, 2, 5, 1});
+    }
+
+    SUBCASE("Writing through a reverse iterator updates the sorted views") {
+        MyContainer<int> c;
+        c.add({5, 6, 7});
+        CHECK(*c.beginAscendingOrder() == 5);
+        *c.beginReverseOrder() = 1;
+        CHECK(*c.beginAscendingOrder() == 1);
+        CHECK(c.beginReverseOrder()[2] == 5);
+    }
+}
+
+//////// SIDE CROSS CURSOR TESTS //////////
+
+TEST_CASE("MyContainer side cross over the ascending view") {
+    SUBCASE("Side cross needs no buffer of its own") {
+        CountingResource counting;
+        MyContainer<int> c(&counting);
+        for (int i = 0; i < 1000; ++i) {
+            c.add((i * 37) % 1000);
+        }
+        const size_t before = counting.live;
+        auto it = c.beginSideCrossOrder();
+        CHECK(counting.live == before + 1); // only the ascending view, the radix sort scratch is freed
+        CHECK(*it == 0);
+        CHECK(*++it == 999);
+        CHECK(*++it == 1);
+        CHECK(it[999] == 500);
+        const size_t allocations = counting.allocations;
+        c.beginAscendingOrder();
+        CHECK(counting.allocations == allocations);
+    }
+
+    SUBCASE("Cursors meet in the middle for every size") {
+        for (int n = 0; n < 7; ++n) {
+            MyContainer<string> c;
+            for (int i = n - 1; i >= 0; --i) {
+                c.add(string(1, static_cast<char>('a' + i)));
+            }
+            string cross;
+            for (auto it = c.beginSideCrossOrder(); it != c.endSideCrossOrder(); ++it) {
+                cross += *it;
+            }
+            const string expected[] = {"", "a", "ab", "acb", "adbc", "aebdc", "afbecd"};
+            CHECK(cross == expected[n]);
+        }
+    }
+
+    SUBCASE("Side cross and ascending iterators are told apart") {
+        MyContainer<int> c;
+        c.add({2, 1, 3});
+        auto cross = c.beginSideCrossOrder();
+        auto ascending = c.beginAscendingOrder();
+        CHECK(cross != ascending);
+        CHECK(*++cross == 3);
+        CHECK(*++ascending == 2);
+    }
+}
+
+//////// VIEW TESTS //////////
+
+TEST_CASE("MyContainer views") {
+    SUBCASE("Views work with range-for and can be traversed again") {
+        MyContainer<int> c;
+        c.add({3, 1, 2});
+        auto ascending = c.ascending();
+        vector<int> seen;
+        for (int value : ascending) {
+            seen.push_back(value);
+        }
+        for (int value : ascending) {
+            seen.push_back(value);
+        }
+        CHECK(seen == vector<int>{1, 2, 3, 1, 2, 3});
+        CHECK(ascending.size() == 3);
+        CHECK(ascending[2] == 3);
+        CHECK_FALSE(ascending.isEmpty());
+        CHECK(MyContainer<int>().descending().isEmpty());
+    }
+
+    SUBCASE("Every order at once") {
+        MyContainer<string> c;
+        c.add({"d", "b", "a", "c"});
+        auto in_order = c.inOrder();
+        auto ascending = c.ascending();
+        auto descending = c.descending();
+        auto cross = c.sideCross();
+        auto reverse = c.reverse();
+        auto middle = c.middleOut();
+        auto by_length = c.sortedWith([](const string &a, const string &b) { return a.size() < b.size(); });
+        auto by_name = c.sortedWith(std::greater<string>());
+        string all;
+        for (auto *view : {&in_order, &ascending, &descending, &cross, &reverse, &middle, &by_length, &by_name}) {
+            for (const string &value : *view) {
+                all += value;
+            }
+            all += ' ';
+        }
+        CHECK(all == "dbac abcd dcba adbc cabd acbd dbac dcba ");
+    }
+
+    SUBCASE("A view blocks changes while it is alive") {
+        MyContainer<int> c;
+        c.add({1, 2});
+        {
+            auto view = c.descending();
+            CHECK_THROWS_AS(c.add(3), ActiveIterator);
+            CHECK_THROWS_AS(c.remove(1), ActiveIterator);
+        }
+        c.add(3);
+        CHECK(c.descending()[0] == 3);
+    }
+
+    SUBCASE("A view keeps its buffer when the cache is rebuilt") {
+        MyContainer<int> c;
+        c.add({5, 7, 6});
+        auto before = c.ascending();
+        c.at(0) = 9;
+        auto after = c.ascending();
+        vector<int> old_order;
+        for (int value : before) {
+            old_order.push_back(value);
+        }
+        vector<int> new_order;
+        for (int value : after) {
+            new_order.push_back(value);
+        }
+        CHECK(old_order == vector<int>{5, 6, 7});
+        CHECK(new_order == vector<int>{6, 7, 9});
+    }
+
+    SUBCASE("Views are started and traversed from several threads") {
+        MyContainer<int> c;
+        for (int i = 0; i < 20000; ++i) {
+            c.add((i * 7919) % 20000);
+        }
+        c.ascending();
+        c.add({-1, 20000}); // the threads race to merge these into the index
+        const long long expected = 19999LL * 20000 / 2 + 19999;
+        vector<long long> sums(6, 0);
+        vector<int> firsts(6, 0);
+        vector<std::thread> threads;
+        for (size_t t = 0; t < sums.size(); ++t) {
+            threads.emplace_back([&c, &sums, &firsts, t] {
+                auto view = t % 3 == 0 ? c.ascending() : t % 3 == 1 ? c.descending() : c.sideCross();
+                for (int value : view) {
+                    sums[t] += value;
+                }
+                firsts[t] = view[0];
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; t < sums.size(); ++t) {
+            CHECK(sums[t] == expected);
+            CHECK(firsts[t] == (t % 3 == 1 ? 20000 : -1));
+        }
+    }
+}
+
+//////// LAZY ASCENDING ORDER TESTS //////////
+
+TEST_CASE("MyContainer lazy ascending order") {
+    SUBCASE("Reading the first few elements does not sort the rest") {
+        MyContainer<Compared> c;
+        const int n = 20000;
+        for (int i = 0; i < n; ++i) {
+            c.add(Compared{(i * 7919) % n});
+        }
+        Compared::comparisons = 0;
+        auto it = c.beginLazyAscendingOrder();
+        vector<int> smallest;
+        for (int i = 0; i < 10; ++i, ++it) {
+            smallest.push_back(it->value);
+        }
+        const size_t lazy_comparisons = Compared::comparisons;
+        CHECK(smallest == vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+        Compared::comparisons = 0;
+        MyContainer<Compared> other;
+        for (int i = 0; i < n; ++i) {
+            other.add(Compared{(i * 7919) % n});
+        }
+        other.beginAscendingOrder();
+        CHECK(lazy_comparisons * 3 < Compared::comparisons);
+    }
+
+    SUBCASE("The full traversal is the stable ascending order") {
+        MyContainer<People> c;
+        c.add({People("A", 30), People("B", 20), People("C", 30), People("D", 10), People("E", 20)});
+        string names;
+        for (const People &p : c.lazyAscending()) {
+            names += p.getName();
+        }
+        CHECK(names == "DBEAC");
+
+        MyContainer<int> numbers;
+        for (int i = 0; i < 1000; ++i) {
+            numbers.add((i * 37) % 101);
+        }
+        vector<int> lazy;
+        for (int value : numbers.lazyAscending()) {
+            lazy.push_back(value);
+        }
+        CHECK(lazy == ascendingValues(numbers));
+    }
+
+    SUBCASE("Later traversals reuse what was sorted, changes start over") {
+        MyContainer<Compared> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(Compared{(i * 7919) % 1000});
+        }
+        for (const Compared &value : c.lazyAscending()) {
+            (void) value;
+        }
+        Compared::comparisons = 0;
+        {
+            auto view = c.lazyAscending();
+            CHECK(view[999].value == 999);
+            CHECK(Compared::comparisons == 0);
+        }
+
+        c.remove(Compared{0});
+        CHECK(c.lazyAscending()[0].value == 1);
+        CHECK(Compared::comparisons > 0);
+    }
+
+    SUBCASE("Empty and indexed from the end") {
+        MyContainer<int> c;
+        CHECK(c.beginLazyAscendingOrder() == c.endLazyAscendingOrder());
+        c.add({4, 2, 9, 1});
+        auto view = c.lazyAscending();
+        CHECK(view[3] == 9);
+        CHECK(view[0] == 1);
+        CHECK(view.size() == 4);
+    }
+}
+
+//////// TOP K TESTS //////////
+
+TEST_CASE("MyContainer topK and bottomK") {
+    SUBCASE("The k largest and the k smallest") {
+        MyContainer<int> c;
+        c.add({5, 9, 1, 7, 3, 8, 2});
+        vector<int> top;
+        for (int value : c.topK(3)) {
+            top.push_back(value);
+        }
+        CHECK(top == vector<int>{9, 8, 7});
+        vector<int> bottom;
+        for (int value : c.bottomK(2)) {
+            bottom.push_back(value);
+        }
+        CHECK(bottom == vector<int>{1, 2});
+        CHECK(c.topK(100).size() == 7);
+        CHECK(c.topK(0).isEmpty());
+        CHECK(MyContainer<int>().bottomK(3).isEmpty());
+    }
+
+    SUBCASE("A custom comparator, ties keep their insertion order") {
+        MyContainer<People> c;
+        c.add({People("A", 30), People("B", 20), People("C", 30), People("D", 10), People("E", 30)});
+        string names;
+        for (const People &p : c.topK(2, [](const People &a, const People &b) { return a.getAge() > b.getAge(); })) {
+            names += p.getName();
+        }
+        CHECK(names == "AC");
+        names.clear();
+        for (const People &p : c.bottomK(3)) {
+            names += p.getName();
+        }
+        CHECK(names == "DBA");
+
+        MyContainer<string> words;
+        words.add({"pear", "fig", "banana", "kiwi", "apple"});
+        auto shortest = words.topK(3, [](const string &a, const string &b) { return a.size() < b.size(); });
+        CHECK(shortest[0] == "fig");
+        CHECK(shortest[1] == "pear");
+        CHECK(shortest[2] == "kiwi");
+    }
+
+    SUBCASE("Matches a full sort and compares O(n log k) times") {
+        MyContainer<Compared> c;
+        const int n = 100000;
+        for (int i = 0; i < n; ++i) {
+            c.add(Compared{(i * 7919) % n});
+        }
+        Compared::comparisons = 0;
+        auto bottom = c.bottomK(10);
+        CHECK(Compared::comparisons < 4 * static_cast<size_t>(n));
+        for (int i = 0; i < 10; ++i) {
+            CHECK(bottom[i].value == i);
+        }
+        auto top = c.topK(5, [](const Compared &a, const Compared &b) { return b < a; });
+        for (int i = 0; i < 5; ++i) {
+            CHECK(top[i].value == n - 1 - i);
+        }
+    }
+}
+
+//////// PARALLEL SORT TESTS //////////
+
+namespace {
+    // Sorts in parallel with small ranges for the duration of a test
+    struct ParallelSortScope {
+        ParallelSortScope(size_t threads, size_t threshold) {
+            ParallelSort::setThreads(threads);
+            ParallelSort::setThreshold(threshold);
+        }
+
+        ~ParallelSortScope() {
+            ParallelSort::setThreads(0);
+            ParallelSort::setThreshold(1 << 16);
+        }
+    };
+
+    // A sortedBy key of a user type, counting the comparisons made off the thread that sorts
+    struct AgeKey {
+        static std::thread::id caller;
+        static size_t elsewhere; // not atomic: only ever touched from one thread
+        int age;
+
+        bool operator<(const AgeKey &other) const {
+            elsewhere += std::this_thread::get_id() != caller;
+            return age < other.age;
+        }
+    };
+
+    std::thread::id AgeKey::caller;
+    size_t AgeKey::elsewhere = 0;
+}
+
+TEST_CASE("MyContainer parallel sort") {
+    SUBCASE("Same result as the sequential sort for any thread count") {
+        vector<int> values;
+        for (int i = 0; i < 5000; ++i) {
+            values.push_back((i * 7919) % 1237);
+        }
+        vector<int> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        for (size_t threads : {1, 2, 3, 4, 7, 8}) {
+            ParallelSortScope scope(threads, 64);
+            vector<int> sorted = values;
+            ParallelSort::stableSort(sorted.begin(), sorted.end(), std::less<int>());
+            CHECK(sorted == expected);
+        }
+    }
+
+    SUBCASE("Views stay stable") {
+        ParallelSortScope scope(4, 64);
+        MyContainer<People> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(People(std::to_string(i), i % 10));
+        }
+        int last_age = -1;
+        int last_name = -1;
+        for (const People &p : c.ascending()) {
+            const int name = std::stoi(p.getName());
+            CHECK(p.getAge() >= last_age);
+            if (p.getAge() == last_age) {
+                CHECK(name > last_name);
+            }
+            last_age = p.getAge();
+            last_name = name;
+        }
+        auto descending = c.sortedWith(std::greater<People>());
+        CHECK(descending[0].getName() == "9");
+        CHECK(descending[1].getName() == "19");
+
+        MyContainer<int> numbers;
+        for (int i = 0; i < 3000; ++i) {
+            numbers.add((i * 37) % 1001);
+        }
+        numbers.ascending();
+        for (int i = 0; i < 500; ++i) {
+            numbers.add(-i); // merged into the index with a parallel sort
+        }
+        vector<int> merged = ascendingValues(numbers);
+        CHECK(std::is_sorted(merged.begin(), merged.end()));
+        CHECK(merged.size() == 3500);
+        CHECK(merged.front() == -499);
+    }
+
+    SUBCASE("User comparators are called from one thread unless allowed") {
+        ParallelSortScope scope(4, 64);
+        MyContainer<People> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(People(std::to_string(i), (i * 37) % 101));
+        }
+        const std::thread::id caller = std::this_thread::get_id();
+        size_t elsewhere = 0; // not atomic: only ever touched from one thread
+        auto byAge = [caller, &elsewhere](const People &a, const People &b) {
+            elsewhere += std::this_thread::get_id() != caller;
+            return a.getAge() < b.getAge();
+        };
+        auto sorted = c.sortedWith(byAge);
+        CHECK(elsewhere == 0);
+        CHECK(sorted[0].getAge() == 0);
+        CHECK(sorted[999].getAge() == 100);
+
+        ParallelSort::setUserComparators(true);
+        auto parallel = c.sortedWith([](const People &a, const People &b) { return a.getAge() > b.getAge(); });
+        ParallelSort::setUserComparators(false);
+        CHECK(parallel[0].getAge() == 100);
+        for (size_t i = 1; i < 1000; ++i) {
+            CHECK(parallel[i - 1].getAge() >= parallel[i].getAge());
+        }
+    }
+
+    SUBCASE("Keys of a user type are compared on one thread unless allowed") {
+        ParallelSortScope scope(4, 64);
+        MyContainer<People> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(People(std::to_string(i), (i * 37) % 101));
+        }
+        AgeKey::caller = std::this_thread::get_id();
+        AgeKey::elsewhere = 0;
+        auto sorted = c.sortedBy([](const People &p) { return AgeKey{p.getAge()}; });
+        CHECK(AgeKey::elsewhere == 0);
+        CHECK(sorted[0].getAge() == 0);
+        CHECK(sorted[999].getAge() == 100);
+
+        auto byName = c.sortedBy([](const People &p) { return p.getName(); }); // std::string keys, in parallel
+        CHECK(byName[0].getName() == "0");
+        CHECK(byName[999].getName() == "999");
+    }
+
+    SUBCASE("An exception from the comparator reaches the caller") {
+        ParallelSortScope scope(4, 64);
+        vector<int> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        CHECK_THROWS_AS(ParallelSort::stableSort(values.begin(), values.end(), [](int a, int b) {
+            if (a == 500 || b == 500) {
+                throw std::runtime_error("no");
+            }
+            return a > b;
+        }), std::runtime_error);
+    }
+}
+
+//////// RADIX SORT TESTS //////////
+
+namespace {
+    // The container's ascending and descending views against std::stable_sort
+    template<typename T>
+    void checkRadixViews(const vector<T> &values) {
+        MyContainer<T> c;
+        c.addRange(values.begin(), values.end());
+        vector<T> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        vector<T> ascending;
+        for (const T &value : c.ascending()) {
+            ascending.push_back(value);
+        }
+        CHECK(ascending == expected);
+        std::stable_sort(expected.begin(), expected.end(), std::greater<T>());
+        vector<T> descending;
+        for (const T &value : c.sortedWith(std::greater<T>())) {
+            descending.push_back(value);
+        }
+        CHECK(descending == expected);
+        vector<T> derived;
+        for (const T &value : c.descending()) {
+            derived.push_back(value);
+        }
+        CHECK(derived == expected);
+    }
+}
+
+TEST_CASE("MyContainer radix sorted views") {
+    SUBCASE("Signed and unsigned integers") {
+        vector<int> ints;
+        vector<unsigned int> unsigneds;
+        vector<size_t> sizes;
+        vector<long long> longs;
+        for (int i = 0; i < 3000; ++i) {
+            const int value = (i * 7919) % 4001 - 2000;
+            ints.push_back(i % 500 == 0 ? (i % 1000 == 0 ? INT32_MIN : INT32_MAX) : value);
+            unsigneds.push_back(static_cast<unsigned int>(value) * 2654435761u);
+            sizes.push_back(static_cast<size_t>(value) << 20);
+            longs.push_back(static_cast<long long>(value) * 1000000007LL);
+        }
+        checkRadixViews(ints);
+        checkRadixViews(unsigneds);
+        checkRadixViews(sizes);
+        checkRadixViews(longs);
+        checkRadixViews(vector<int>(1000, 7)); // every pass skipped
+    }
+
+    SUBCASE("Floating point, negative zero and infinities") {
+        vector<double> doubles;
+        vector<float> floats;
+        for (int i = 0; i < 3000; ++i) {
+            const double value = ((i * 7919) % 4001 - 2000) / 7.0;
+            doubles.push_back(value);
+            floats.push_back(static_cast<float>(value * 1e10));
+        }
+        doubles[10] = -0.0;
+        doubles[20] = 0.0;
+        doubles[30] = -0.0;
+        doubles[40] = std::numeric_limits<double>::infinity();
+        doubles[50] = -std::numeric_limits<double>::infinity();
+        doubles[60] = std::numeric_limits<double>::denorm_min();
+        doubles[70] = -std::numeric_limits<double>::max();
+        floats[5] = -0.0f;
+        floats[6] = std::numeric_limits<float>::lowest();
+        checkRadixViews(doubles);
+        checkRadixViews(floats);
+
+        // -0.0 and 0.0 are equal, so they keep their insertion order like with std::stable_sort
+        MyContainer<double> c;
+        c.addRange(doubles.begin(), doubles.end());
+        vector<bool> zero_signs;
+        for (double value : c.ascending()) {
+            if (value == 0) {
+                zero_signs.push_back(std::signbit(value));
+            }
+        }
+        vector<bool> expected_signs;
+        for (double value : doubles) {
+            if (value == 0) {
+                expected_signs.push_back(std::signbit(value));
+            }
+        }
+        CHECK(zero_signs.size() > 3);
+        CHECK(zero_signs == expected_signs);
+    }
+
+    SUBCASE("Characters by counting") {
+        vector<char> chars;
+        vector<signed char> signed_chars;
+        vector<unsigned char> unsigned_chars;
+        for (int i = 0; i < 2000; ++i) {
+            chars.push_back(static_cast<char>((i * 37) % 256));
+            signed_chars.push_back(static_cast<signed char>((i * 91) % 256));
+            unsigned_chars.push_back(static_cast<unsigned char>((i * 13) % 256));
+        }
+        checkRadixViews(chars);
+        checkRadixViews(signed_chars);
+        checkRadixViews(unsigned_chars);
+    }
+
+    SUBCASE("New elements are radix sorted into the index") {
+        MyContainer<int> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add((i * 37) % 1000);
+        }
+        c.ascending();
+        for (int i = 0; i < 600; ++i) {
+            c.add(-((i * 11) % 600));
+        }
+        vector<int> values = ascendingValues(c);
+        CHECK(std::is_sorted(values.begin(), values.end()));
+        CHECK(values.size() == 1600);
+        CHECK(values.front() == -599);
+    }
+}
+
+//////// SIMD SORT TESTS //////////
+
+namespace {
+    // Every size the kernels take, at every level this CPU runs, against std::stable_sort
+    template<typename T>
+    void checkSimdSort(T low, T high) {
+        std::mt19937_64 random(7);
+        for (SimdSort::Level level : {SimdSort::Scalar, SimdSort::Sse2, SimdSort::Avx2}) {
+            if (!SimdSort::supports(level)) {
+                continue;
+            }
+            for (size_t size = 0; size <= SimdSort::capacity; ++size) {
+                vector<T> values(size);
+                for (T &value : values) {
+                    value = static_cast<T>(random() % 2001) - static_cast<T>(1000);
+                    if (value == 0) {
+                        value = 1; // zeros take the stable_sort path, tested below
+                    }
+                }
+                if (size > 2) {
+                    values[size / 2] = low;
+                    values[size / 3] = high;
+                }
+                vector<T> expected = values;
+                std::stable_sort(expected.begin(), expected.end());
+                SimdSort::sort(values.data(), values.data() + size, level);
+                CHECK(values == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("MyContainer SIMD sort kernels") {
+    SUBCASE("Every element type and size") {
+        checkSimdSort<int32_t>(INT32_MIN, INT32_MAX);
+        checkSimdSort<uint32_t>(0, UINT32_MAX);
+        checkSimdSort<int64_t>(INT64_MIN, INT64_MAX);
+        checkSimdSort<uint64_t>(1, UINT64_MAX);
+        checkSimdSort<float>(-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::max());
+        checkSimdSort<double>(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::infinity());
+    }
+
+    SUBCASE("Small views use the kernels and keep the order of equal zeros") {
+        vector<int> ints;
+        vector<double> doubles;
+        vector<size_t> sizes;
+        for (int i = 0; i < 200; ++i) {
+            ints.push_back((i * 7919) % 301 - 150);
+            doubles.push_back(((i * 31) % 17 - 8) / 3.0);
+            sizes.push_back(static_cast<size_t>((i * 13) % 50));
+        }
+        doubles[3] = -0.0;
+        checkRadixViews(ints);
+        checkRadixViews(doubles);
+        checkRadixViews(sizes);
+
+        MyContainer<double> c;
+        c.add({0.0, -0.0, 1.0, -1.0, 0.0});
+        string signs;
+        for (double value : c.ascending()) {
+            signs += std::signbit(value) ? '-' : '+';
+        }
+        CHECK(signs == "-+-++");
+        signs.clear();
+        for (double value : c.descending()) {
+            signs += std::signbit(value) ? '-' : '+';
+        }
+        CHECK(signs == "++-+-");
+    }
+}
+
+//////// SORTED BY KEY TESTS //////////
+
+TEST_CASE("MyContainer sorted by key") {
+    SUBCASE("Each key is extracted once") {
+        MyContainer<People> c;
+        for (int i = 0; i < 500; ++i) {
+            c.add(People("name" + std::to_string((i * 7919) % 500), i % 90));
+        }
+        size_t extractions = 0;
+        auto by_name = c.sortedBy([&extractions](const People &p) {
+            ++extractions;
+            return p.getName();
+        });
+        CHECK(extractions == 500);
+        auto with_name = c.sortedWith([](const People &a, const People &b) { return a.getName() < b.getName(); });
+        for (size_t i = 0; i < 500; ++i) {
+            CHECK(&by_name[i] == &with_name[i]);
+        }
+    }
+
+    SUBCASE("Equal keys keep their insertion order") {
+        MyContainer<People> c;
+        c.add({People("A", 30), People("B", 20), People("C", 30), People("D", 10), People("E", 20)});
+        string names;
+        for (auto it = c.beginSortedBy(&People::getAge); it != c.endSortedBy(); ++it) {
+            names += it->getName();
+        }
+        CHECK(names == "DBEAC");
+    }
+
+    SUBCASE("Keys of any type ordered by <") {
+        MyContainer<string> words;
+        words.add({"pear", "fig", "banana", "kiwi", "apple"});
+        string joined;
+        for (const string &word : words.sortedBy([](const string &w) { return std::make_pair(w.size(), w.back()); })) {
+            joined += word + ' ';
+        }
+        CHECK(joined == "fig kiwi pear apple banana ");
+
+        MyContainer<int> numbers;
+        numbers.add({-3, 2, -1, 4});
+        vector<int> by_magnitude;
+        for (int value : numbers.sortedBy([](int value) { return value < 0 ? -value : value; })) {
+            by_magnitude.push_back(value);
+        }
+        CHECK(by_magnitude == vector<int>{-1, 2, -3, 4});
+        CHECK(MyContainer<int>().sortedBy([](int value) { return value; }).isEmpty());
+    }
+}
+
+//////// PRESORTED RUN TESTS //////////
+
+TEST_CASE("MyContainer presorted runs") {
+    SUBCASE("A container filled in order needs no sort") {
+        MyContainer<Compared> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(Compared{i / 2});
+        }
+        Compared::comparisons = 0;
+        auto ascending = c.ascending();
+        CHECK(Compared::comparisons == 0);
+        CHECK(ascending[999].value == 499);
+        auto descending = c.descending();
+        CHECK(descending[0].value == 499);
+        CHECK(Compared::comparisons < 2000); // only finding the runs of equal elements
+    }
+
+    SUBCASE("Filled in reverse order") {
+        MyContainer<Compared> c;
+        for (int i = 1000; i > 0; --i) {
+            c.add(Compared{i});
+        }
+        Compared::comparisons = 0;
+        CHECK(c.ascending()[0].value == 1);
+        CHECK(Compared::comparisons == 0);
+    }
+
+    SUBCASE("Sorted data found again after a write costs O(n)") {
+        MyContainer<Compared> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(Compared{i});
+        }
+        c.at(0) = Compared{-1};
+        Compared::comparisons = 0;
+        CHECK(c.ascending()[0].value == -1);
+        CHECK(Compared::comparisons <= 1000);
+
+        c.at(500) = Compared{2000}; // two runs
+        Compared::comparisons = 0;
+        vector<int> values;
+        for (const Compared &value : c.ascending()) {
+            values.push_back(value.value);
+        }
+        CHECK(std::is_sorted(values.begin(), values.end()));
+        CHECK(values.back() == 2000);
+        CHECK(Compared::comparisons < 3000);
+    }
+
+    SUBCASE("Runs in both directions keep equal elements in order") {
+        MyContainer<People> c;
+        c.add({People("A", 5), People("B", 5), People("C", 4), People("D", 3), People("E", 3),
+               People("F", 9), People("G", 1)});
+        string names;
+        for (const People &p : c.ascending()) {
+            names += p.getName();
+        }
+        CHECK(names == "GDECABF");
+        names.clear();
+        for (const People &p : c.descending()) {
+            names += p.getName();
+        }
+        CHECK(names == "FABCDEG");
+    }
+
+    SUBCASE("Any mix of runs matches std::stable_sort") {
+        std::mt19937 random(3);
+        for (int round = 0; round < 50; ++round) {
+            vector<std::pair<int, int>> values;
+            while (values.size() < 2000) {
+                const size_t length = 1 + random() % 300;
+                const int start = static_cast<int>(random() % 100);
+                const int step = static_cast<int>(random() % 5) - 2;
+                for (size_t i = 0; i < length; ++i) {
+                    values.emplace_back(start + step * static_cast<int>(i), static_cast<int>(values.size()));
+                }
+            }
+            const auto by_key = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+            vector<std::pair<int, int>> expected = values;
+            std::stable_sort(expected.begin(), expected.end(), by_key);
+            CHECK(RunSort::sort(values.begin(), values.end(), by_key));
+            CHECK(values == expected);
+        }
+        vector<int> shuffled(1000);
+        std::iota(shuffled.begin(), shuffled.end(), 0);
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+        const vector<int> before = shuffled;
+        CHECK_FALSE(RunSort::sort(shuffled.begin(), shuffled.end(), std::less<int>()));
+        CHECK(shuffled == before);
+    }
+}
+
+//////// EXTERNAL SORT TESTS //////////
+
+TEST_CASE("MyContainer external ascending order") {
+    SUBCASE("A tiny budget spills runs and merges them in several passes") {
+        MyContainer<int> c;
+        for (int i = 0; i < 10000; ++i) {
+            c.add((i * 7919) % 10007 - 5000);
+        }
+        vector<int> expected = ascendingValues(c);
+        auto view = c.externalAscending(256);
+        vector<int> values;
+        for (int value : view) {
+            values.push_back(value);
+        }
+        CHECK(values == expected);
+        CHECK(view.size() == 10000);
+        CHECK(view.runCount() == 313); // 32 ints per run, sorted with a scratch of 32 more
+        CHECK(view.peakMemory() == 256); // the chunk and its sort scratch fill the budget exactly
+    }
+
+#ifdef __unix__
+    SUBCASE("More runs than the process may open files") {
+        // Lowers the limit on open files for the duration of the test
+        struct FileLimitScope {
+            rlimit saved{};
+
+            explicit FileLimitScope(rlim_t files) {
+                getrlimit(RLIMIT_NOFILE, &saved);
+                const rlimit lowered{std::min(saved.rlim_cur, files), saved.rlim_max};
+                setrlimit(RLIMIT_NOFILE, &lowered);
+            }
+
+            ~FileLimitScope() {
+                setrlimit(RLIMIT_NOFILE, &saved);
+            }
+        };
+        MyContainer<int> c;
+        for (int i = 0; i < 100000; ++i) {
+            c.add((i * 7919) % 100003 - 50000);
+        }
+        vector<int> expected = ascendingValues(c);
+        vector<int> values;
+        size_t runs = 0;
+        {
+            FileLimitScope scope(128);
+            auto view = c.externalAscending(256);
+            for (int value : view) {
+                values.push_back(value);
+            }
+            runs = view.runCount();
+        }
+        CHECK(runs == 3125); // 32 ints per run, each once in its own file
+        CHECK(values == expected);
+    }
+#endif
+
+    SUBCASE("Views of indices keep equal elements in insertion order") {
+        MyContainer<People> c;
+        for (int i = 0; i < 300; ++i) {
+            c.add(People(std::to_string(i), (i * 7) % 10));
+        }
+        auto view = c.externalAscending(200);
+        CHECK(view.runCount() > 1);
+        int last_age = -1;
+        int last_name = -1;
+        size_t count = 0;
+        for (auto it = view.begin(); it != view.end(); ++it, ++count) {
+            const int name = std::stoi(it->getName());
+            CHECK(it->getAge() >= last_age);
+            if (it->getAge() == last_age) {
+                CHECK(name > last_name);
+            }
+            last_age = it->getAge();
+            last_name = name;
+        }
+        CHECK(count == 300);
+        CHECK(view.peakMemory() <= 200);
+    }
+
+    SUBCASE("Chunks are merge sorted stably within the budget") {
+        MyContainer<People> c;
+        for (int i = 0; i < 3000; ++i) {
+            c.add(People(std::to_string(i), (i * 31) % 7));
+        }
+        for (size_t budget : {size_t{8000}, size_t{1 << 16}}) { // 500 indices per chunk, or all of them
+            auto view = c.externalAscending(budget);
+            CHECK((view.runCount() > 1) == (budget == 8000));
+            int last_age = -1;
+            int last_name = -1;
+            size_t count = 0;
+            for (const People &p : view) {
+                const int name = std::stoi(p.getName());
+                CHECK(p.getAge() >= last_age);
+                if (p.getAge() == last_age) {
+                    CHECK(name > last_name);
+                }
+                last_age = p.getAge();
+                last_name = name;
+                ++count;
+            }
+            CHECK(count == 3000);
+            CHECK(view.peakMemory() <= budget);
+        }
+    }
+
+    SUBCASE("Small containers are sorted in memory") {
+        MyContainer<double> c;
+        c.add({2.5, -1.0, 3.0});
+        auto view = c.externalAscending(1 << 20);
+        CHECK(view.runCount() == 0);
+        vector<double> values(view.begin(), view.end());
+        CHECK(values == vector<double>{-1.0, 2.5, 3.0});
+
+        MyContainer<int> empty;
+        auto nothing = empty.externalAscending(64);
+        CHECK(nothing.begin() == nothing.end());
+    }
+
+    SUBCASE("The view blocks changes and traverses once") {
+        MyContainer<int> c;
+        c.add({3, 1, 2});
+        {
+            auto view = c.externalAscending(8);
+            CHECK_THROWS_AS(c.add(4), ActiveIterator);
+            auto it = view.begin();
+            auto stale = it;
+            CHECK(*it == 1);
+            ++it;
+            CHECK(*it == 2);
+            CHECK_THROWS_AS(*stale, OutOfRange);
+            ++it;
+            ++it;
+            CHECK(it == view.end());
+            CHECK_THROWS_AS(++it, OutOfRange);
+        }
+        c.add(4);
+        CHECK(c.size() == 4);
+    }
+}
+
+//////// HASH INDEX TESTS //////////
+
+namespace {
+    // int that counts how often it is compared with == or !=
+    struct Matched {
+        static size_t comparisons;
+        int value;
+
+        bool operator==(const Matched &other) const {
+            ++comparisons;
+            return value == other.value;
+        }
+
+        bool operator!=(const Matched &other) const { return !(*this == other); }
+
+        bool operator<(const Matched &other) const { return value < other.value; }
+    };
+
+    size_t Matched::comparisons = 0;
+}
+
+template<>
+struct std::hash<Matched> {
+    size_t operator()(const Matched &m) const { return std::hash<int>()(m.value); }
+};
+
+TEST_CASE("MyContainer hash index") {
+    SUBCASE("Random adds and removes agree with a multiset") {
+        MyContainer<int> c;
+        c.setHashIndex(true);
+        CHECK(c.hasHashIndex());
+        multiset<int> reference;
+        mt19937 random(22);
+        for (int step = 0; step < 20000; ++step) {
+            const int value = static_cast<int>(random() % 500) * 1024; // clustered low bits
+            if (random() % 3 == 0) {
+                if (reference.count(value) == 0) {
+                    CHECK_THROWS_AS(c.remove(value), ElementNotFound);
+                } else {
+                    c.remove(value);
+                    reference.erase(value);
+                }
+            } else {
+                c.add(value);
+                reference.insert(value);
+            }
+            const int probe = static_cast<int>(random() % 500) * 1024;
+            REQUIRE(c.contains(probe) == (reference.count(probe) > 0));
+        }
+        CHECK(c.size() == reference.size());
+        CHECK(ascendingValues(c) == vector<int>(reference.begin(), reference.end()));
+    }
+
+    SUBCASE("Removing keeps the order of the rest") {
+        MyContainer<string> c;
+        c.setHashIndex(true);
+        c.add({"b", "a", "c", "a", "d", "a", "e"});
+        CHECK(c.contains("a"));
+        c.remove("a");
+        CHECK_FALSE(c.contains("a"));
+        ostringstream out;
+        out << c;
+        CHECK(out.str() == "[b, c, d, e]");
+        c.remove("d");
+        c.add("a");
+        CHECK(c.contains("a"));
+        CHECK(c.contains("e"));
+        c.remove("b");
+        out.str("");
+        out << c;
+        CHECK(out.str() == "[c, e, a]");
+        c.remove("c");
+        c.remove("e");
+        c.remove("a");
+        CHECK(c.isEmpty());
+        CHECK_FALSE(c.contains("a"));
+        CHECK_THROWS_AS(c.remove("a"), ElementNotFound);
+    }
+
+    SUBCASE("Writes through set() are seen by the next lookup") {
+        MyContainer<int> c;
+        c.setHashIndex(true);
+        c.add({1, 2, 3, 2});
+        CHECK(c.contains(2));
+        c.set(1, 7);
+        CHECK(c.contains(2));
+        CHECK(c.count(2) == 1);
+        c.set(3, 7);
+        CHECK_FALSE(c.contains(2));
+        CHECK(c.count(7) == 2);
+        c.set(2, 1);
+        CHECK(*c.find(1) == 1);
+        CHECK_FALSE(c.contains(3));
+        c.remove(7);
+        CHECK(c.size() == 2);
+        CHECK(c.count(1) == 2);
+        CHECK_THROWS_AS(c.set(2, 0), OutOfRange);
+        for (auto it = c.begin(); it != c.end(); ++it) {
+            *it *= 10;
+        }
+        CHECK(c.contains(10));
+        CHECK_FALSE(c.contains(1));
+        c.add({5, 6});
+        CHECK(c.contains(6));
+        c.set(0, 6); // before the first 6 the index knew of
+        CHECK(c.find(6) == c.begin());
+    }
+
+    SUBCASE("Writes through at() are seen by the next lookup") {
+        MyContainer<int> c;
+        c.setHashIndex(true);
+        c.add({1, 2, 3});
+        CHECK(c.contains(1));
+        c.at(0) = 42;
+        CHECK(c.contains(42));
+        CHECK(c.count(42) == 1);
+        CHECK(c.find(42) != c.end());
+        CHECK_NOTHROW(c.remove(42));
+        CHECK_FALSE(c.contains(1));
+        CHECK_FALSE(c.contains(42));
+        c.at(1) = 2;
+        c.set(0, 5); // after a write through at(), set() leaves the rebuild to the lookup
+        CHECK(c.count(2) == 1);
+        CHECK(c.count(5) == 1);
+        CHECK(c.count(3) == 0);
+        c.remove(5);
+        CHECK(c.size() == 1);
+        CHECK(c.at(0) == 2);
+    }
+
+    SUBCASE("Const access and set() do not rebuild the index") {
+        MyContainer<Matched> c;
+        c.setHashIndex(true);
+        for (int i = 0; i < 1000; ++i) {
+            c.add(Matched{i % 10});
+        }
+        CHECK(c.contains(Matched{3}));
+        const MyContainer<Matched> &view = c;
+        int sum = 0;
+        for (size_t i = 0; i < view.size(); ++i) {
+            sum += view.at(i).value;
+        }
+        CHECK(sum == 4500);
+        Matched::comparisons = 0;
+        c.set(0, Matched{7});
+        CHECK(c.contains(Matched{9}));
+        CHECK(c.count(Matched{7}) == 101);
+        const auto found = c.find(Matched{7});
+        CHECK(Matched::comparisons < 200); // a rebuild alone compares about a thousand times
+        CHECK(found == c.begin());
+    }
+
+    SUBCASE("A miss compares nothing and a remove compares only up to the last match") {
+        MyContainer<Matched> c;
+        c.setHashIndex(true);
+        for (int i = 0; i < 10000; ++i) {
+            c.add(Matched{i});
+        }
+        c.add(Matched{5000});
+        CHECK(c.contains(Matched{42}));
+        Matched::comparisons = 0;
+        CHECK_FALSE(c.contains(Matched{-1}));
+        CHECK_THROWS_AS(c.remove(Matched{10000}), ElementNotFound);
+        CHECK(Matched::comparisons < 10);
+        c.remove(Matched{9990});
+        CHECK(Matched::comparisons < 20);
+        c.remove(Matched{5000});
+        CHECK(Matched::comparisons < 5100);
+        CHECK(c.size() == 9998);
+        CHECK(c.at(5000).value == 5001);
+        CHECK(c.at(9989).value == 9991);
+        CHECK(c.contains(Matched{9999}));
+        CHECK_FALSE(c.contains(Matched{5000}));
+    }
+
+    SUBCASE("Many removes do not leave the first positions far behind") {
+        MyContainer<Matched> c;
+        c.setHashIndex(true);
+        for (int i = 0; i < 2000; ++i) {
+            c.add(Matched{i});
+        }
+        CHECK(c.contains(Matched{999}));
+        for (int i = 1999; i >= 1000; --i) {
+            c.remove(Matched{i});
+        }
+        Matched::comparisons = 0;
+        const auto found = c.find(Matched{999});
+        CHECK(Matched::comparisons < 300); // from the first element it would compare a thousand times
+        CHECK(found->value == 999);
+        CHECK(c.size() == 1000);
+    }
+
+    SUBCASE("Copies and moves keep the setting") {
+        MyContainer<int> c;
+        c.setHashIndex(true);
+        c.add({4, 5, 6});
+        MyContainer<int> copy(c);
+        CHECK(copy.hasHashIndex());
+        CHECK(copy.contains(5));
+        MyContainer<int> moved(std::move(copy));
+        CHECK(moved.hasHashIndex());
+        CHECK(moved.contains(6));
+        moved.remove(6);
+        CHECK_FALSE(moved.contains(6));
+        MyContainer<int> assigned;
+        assigned = c;
+        CHECK(assigned.hasHashIndex());
+        CHECK(assigned.contains(4));
+        c.setHashIndex(false);
+        CHECK_FALSE(c.hasHashIndex());
+        CHECK(c.contains(4));
+        c.remove(4);
+        CHECK_FALSE(c.contains(4));
+    }
+}
+
+//////// SIMD SEARCH TESTS //////////
+
+namespace {
+    // find and count at every level this CPU runs against std::find and std::count, at every length and
+    // at unaligned starts, with few distinct values so matches land in every lane
+    template<typename T>
+    void checkSimdSearch() {
+        std::mt19937_64 random(23);
+        T values[300];
+        for (T &value : values) {
+            value = static_cast<T>(random() % 5);
+        }
+        for (SimdSort::Level level : {SimdSort::Scalar, SimdSort::Sse2, SimdSort::Avx2}) {
+            if (!SimdSort::supports(level)) {
+                continue;
+            }
+            for (size_t offset = 0; offset < 3; ++offset) {
+                for (size_t size = 0; offset + size <= std::size(values); size += 1 + size / 16) {
+                    const T *first = values + offset;
+                    const T *last = first + size;
+                    for (int wanted = 0; wanted <= 5; ++wanted) {
+                        const T value = static_cast<T>(wanted);
+                        REQUIRE(SimdSearch::find(first, last, value, level) == static_cast<size_t>(std::find(first, last, value) - first));
+                        REQUIRE(SimdSearch::count(first, last, value, level) == static_cast<size_t>(std::count(first, last, value)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("MyContainer SIMD search") {
+    SUBCASE("Kernels match std::find and std::count") {
+        checkSimdSearch<int8_t>();
+        checkSimdSearch<uint16_t>();
+        checkSimdSearch<int>();
+        checkSimdSearch<uint64_t>();
+        checkSimdSearch<float>();
+        checkSimdSearch<double>();
+        checkSimdSearch<char>();
+        checkSimdSearch<bool>();
+    }
+
+    SUBCASE("Floats compare like ==") {
+        const vector<double> values{1.5, -0.0, NAN, 2.5, 0.0, 1.5, 1.5, 3.0, -0.0};
+        for (SimdSort::Level level : {SimdSort::Scalar, SimdSort::Sse2, SimdSort::Avx2}) {
+            if (!SimdSort::supports(level)) {
+                continue;
+            }
+            const double *first = values.data();
+            const double *last = first + values.size();
+            CHECK(SimdSearch::find(first, last, 0.0, level) == 1);
+            CHECK(SimdSearch::count(first, last, -0.0, level) == 3);
+            CHECK(SimdSearch::find(first, last, static_cast<double>(NAN), level) == values.size());
+            CHECK(SimdSearch::count(first, last, 1.5, level) == 3);
+        }
+    }
+
+    SUBCASE("find, count, contains and remove of the container") {
+        MyContainer<int> c;
+        for (int i = 0; i < 1000; ++i) {
+            c.add(i % 7);
+        }
+        {
+            auto it = c.find(3);
+            CHECK(*it == 3);
+            CHECK(it == ++++++c.begin());
+            CHECK(c.find(9) == c.end());
+        }
+        CHECK(c.count(3) == 143);
+        CHECK(c.count(6) == 142);
+        CHECK(c.count(9) == 0);
+        CHECK_FALSE(c.contains(7));
+        c.remove(3);
+        CHECK(c.size() == 857);
+        CHECK_FALSE(c.contains(3));
+        for (size_t i = 0; i < c.size(); ++i) {
+            const int expected = static_cast<int>(i / 6 * 7 + i % 6);
+            REQUIRE(c.at(i) == (expected % 7 < 3 ? expected % 7 : expected % 7 + 1));
+        }
+
+        MyContainer<string> words;
+        words.add({"a", "b", "a", "c"});
+        CHECK(words.count("a") == 2);
+        CHECK(*words.find("c") == "c");
+        CHECK(words.find("d") == words.end());
+        words.setHashIndex(true);
+        CHECK(words.count("a") == 2);
+        CHECK(words.count("d") == 0);
+        CHECK(*words.find("b") == "b");
+        CHECK(words.find("d") == words.end());
+    }
+}
+
+//////// RANGE QUERY TESTS //////////
+
+TEST_CASE("MyContainer range queries over the ascending view") {
+    SUBCASE("Bounds and counts match a sorted vector") {
+        MyContainer<int> c;
+        vector<int> sorted;
+        mt19937 random(24);
+        for (int i = 0; i < 2000; ++i) {
+            const int value = static_cast<int>(random() % 500);
+            c.add(value);
+            sorted.push_back(value);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for (int value = -1; value <= 501; value += 3) {
+            const size_t lower = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+            const size_t upper = static_cast<size_t>(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+            auto it = c.lowerBound(value);
+            auto end = c.endAscendingOrder();
+            if (lower < sorted.size()) {
+                REQUIRE(*it == sorted[lower]);
+            } else {
+                REQUIRE(it == end);
+            }
+            auto range = c.equalRange(value);
+            size_t equal = 0;
+            for (; range.first != range.second; ++range.first) {
+                REQUIRE(*range.first == value);
+                ++equal;
+            }
+            REQUIRE(equal == upper - lower);
+            REQUIRE(range.second == c.upperBound(value));
+            REQUIRE(c.countInRange(value, value + 50) ==
+                    static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), value + 50) - sorted.begin()) - lower);
+        }
+        CHECK(c.countInRange(10, 10) == 0);
+        CHECK(c.countInRange(300, 100) == 0);
+        CHECK(c.countInRange(-100, 1000) == 2000);
+        CHECK(MyContainer<int>().countInRange(0, 10) == 0);
+    }
+
+    SUBCASE("Walking from a bound reaches the end of the ascending order") {
+        MyContainer<string> c;
+        c.add({"pear", "fig", "banana", "kiwi", "apple", "fig"});
+        vector<string> tail;
+        for (auto it = c.lowerBound("fig"); it != c.endAscendingOrder(); ++it) {
+            tail.push_back(*it);
+        }
+        CHECK(tail == vector<string>{"fig", "fig", "kiwi", "pear"});
+        CHECK(c.countInRange("b", "g") == 3);
+        auto figs = c.equalRange("fig");
+        CHECK(figs.first != figs.second);
+        CHECK(*figs.first == "fig");
+
+        MyContainer<People> people;
+        people.add({People("A", 30), People("B", 20), People("C", 40), People("D", 25)});
+        CHECK(people.countInRange(People("", 20), People("", 31)) == 3);
+        CHECK(people.upperBound(People("", 40)) == people.endAscendingOrder());
+    }
+
+    SUBCASE("Queries on an unchanged container are logarithmic") {
+        MyContainer<Compared> c;
+        const int n = 1 << 16;
+        for (int i = 0; i < n; ++i) {
+            c.add(Compared{(i * 7919) % n});
+        }
+        CHECK(c.countInRange(Compared{0}, Compared{n}) == static_cast<size_t>(n));
+        Compared::comparisons = 0;
+        for (int i = 0; i < 100; ++i) {
+            CHECK(c.countInRange(Compared{i * 10}, Compared{i * 10 + 100}) == 100);
+        }
+        CHECK(Compared::comparisons <= 100 * 2 * 17);
+        c.add(Compared{5});
+        c.remove(Compared{6});
+        CHECK(c.countInRange(Compared{0}, Compared{10}) == 10);
+        CHECK(*c.lowerBound(Compared{6}) == Compared{7});
+    }
+}
+
+//////// EYTZINGER LAYOUT TESTS //////////
+
+TEST_CASE("MyContainer Eytzinger layout") {
+    SUBCASE("The layout finds the ranks of a sorted array") {
+        for (size_t n : {size_t{0}, size_t{1}, size_t{2}, size_t{7}, size_t{8}, size_t{100}, size_t{1023}, size_t{5000}}) {
+            vector<int> sorted(n);
+            for (size_t i = 0; i < n; ++i) {
+                sorted[i] = static_cast<int>(i / 3 * 2); // runs of equal keys with gaps between them
+            }
+            EytzingerLayout<int> layout(std::pmr::get_default_resource());
+            layout.build(sorted.data(), n);
+            CHECK(layout.size() == n);
+            for (int value = -1; value <= static_cast<int>(n) + 1; ++value) {
+                REQUIRE(layout.lowerBound(value) == static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin()));
+                REQUIRE(layout.upperBound(value) == static_cast<size_t>(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin()));
+                REQUIRE(layout.contains(value) == std::binary_search(sorted.begin(), sorted.end(), value));
+            }
+        }
+    }
+
+    SUBCASE("Range queries and contains on a large container agree with the flat search") {
+        MyContainer<double> c;
+        MyContainer<double> flat;
+        c.setEytzingerLayout(true);
+        CHECK(c.hasEytzingerLayout());
+        mt19937 random(25);
+        for (int i = 0; i < 20000; ++i) {
+            const double value = static_cast<double>(random() % 9000) / 4;
+            c.add(value);
+            flat.add(value);
+        }
+        for (int round = 0; round < 3; ++round) {
+            for (double value = -1; value < 2240; value += 7.25) {
+                REQUIRE(c.countInRange(value, value + 40) == flat.countInRange(value, value + 40));
+                REQUIRE(*c.lowerBound(value + 0.5) == *flat.lowerBound(value + 0.5));
+                REQUIRE(c.contains(value) == flat.contains(value));
+            }
+            {
+                auto range = c.equalRange(10.0);
+                size_t tens = 0;
+                for (; range.first != range.second; ++range.first) {
+                    ++tens;
+                }
+                CHECK(tens == flat.countInRange(10.0, 10.25));
+            }
+            // Changes are seen by the next query
+            c.add(10.0);
+            flat.add(10.0);
+            const double gone = 20.0 + round;
+            c.add(gone);
+            flat.add(gone);
+            c.remove(gone);
+            flat.remove(gone);
+            CHECK_FALSE(c.contains(gone));
+            CHECK(c.countInRange(gone, gone + 0.25) == 0);
+        }
+        MyContainer<double> copy(c);
+        CHECK(copy.hasEytzingerLayout());
+        CHECK(copy.countInRange(0, 3000) == c.size());
+        c.setEytzingerLayout(false);
+        CHECK(c.countInRange(0, 3000) == copy.size());
+    }
+}